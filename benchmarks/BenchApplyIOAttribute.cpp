@@ -0,0 +1,205 @@
+//
+//
+//
+
+#include "llvm/IR/LLVMContext.h"
+// using llvm::LLVMContext
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/LegacyPassManager.h"
+// using llvm::legacy::PassManager
+
+#include "llvm/Analysis/TargetLibraryInfo.h"
+// using llvm::TargetLibraryInfoImpl
+// using llvm::TargetLibraryInfo
+// using llvm::TargetLibraryInfoWrapperPass
+
+#include "llvm/ADT/Triple.h"
+// using llvm::Triple
+
+#include "benchmark/benchmark.h"
+// using benchmark::State
+// using benchmark::DoNotOptimize
+
+#include <memory>
+// using std::unique_ptr
+
+#include <string>
+// using std::string
+// using std::to_string
+
+#include <vector>
+// using std::vector
+
+#include "BWList.hpp"
+
+#include "CxxStreamMatcher.hpp"
+// using icsa::getCxxStreamIOCategories
+
+#include "ApplyIOAttribute.hpp"
+
+#include "ApplyIOAttributePass.hpp"
+
+#include "SyntheticModule.hpp"
+
+namespace icsa {
+namespace {
+
+const long MinNumFunctions = 1 << 10;
+const long MaxNumFunctions = 1 << 20;
+
+std::unique_ptr<llvm::Module> generate(llvm::LLVMContext &Ctx, long N) {
+  SyntheticModuleConfig config;
+  config.NumFunctions = N;
+
+  return generateSyntheticModule(Ctx, config);
+}
+
+void BM_RunOnModule(benchmark::State &State) {
+  llvm::LLVMContext ctx;
+  auto M = generate(ctx, State.range(0));
+  llvm::Triple triple(M->getTargetTriple());
+
+  for (auto _ : State) {
+    State.PauseTiming();
+    for (auto &func : *M)
+      func.removeFnAttr("icsa-io");
+
+    llvm::legacy::PassManager PM;
+    PM.add(new llvm::TargetLibraryInfoWrapperPass(triple));
+    PM.add(new ApplyIOAttributePass());
+    State.ResumeTiming();
+
+    PM.run(*M);
+  }
+
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+
+void BM_HasIO(benchmark::State &State) {
+  llvm::LLVMContext ctx;
+  auto M = generate(ctx, State.range(0));
+  llvm::TargetLibraryInfoImpl TLII(llvm::Triple(M->getTargetTriple()));
+  llvm::TargetLibraryInfo TLI(TLII);
+
+  ApplyIOAttribute aioattr(TLI);
+  aioattr.classify(*M);
+
+  for (auto _ : State)
+    for (const auto &func : *M)
+      if (!func.isDeclaration())
+        benchmark::DoNotOptimize(aioattr.hasIO(func));
+
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+
+void BM_BWListMatches(benchmark::State &State) {
+  const auto numPatterns = State.range(1);
+  BWList list;
+
+  for (long i = 0; i < numPatterns; ++i)
+    list.addRegex("f" + std::to_string(i * 7) + ".*");
+
+  list.compile();
+
+  std::vector<std::string> names;
+  for (long i = 0; i < State.range(0); ++i)
+    names.push_back("f" + std::to_string(i));
+
+  for (auto _ : State)
+    for (const auto &name : names)
+      benchmark::DoNotOptimize(list.matches(name));
+
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+
+// unlike the prefixes above, these patterns are not plain names, so they are
+// matched by the automaton of the compiled list
+void BM_BWListRegexMatches(benchmark::State &State) {
+  const auto numPatterns = State.range(1);
+  BWList list;
+
+  for (long i = 0; i < numPatterns; ++i)
+    list.addRegex("f" + std::to_string(i * 7) + "_[a-z]+");
+
+  list.compile();
+
+  std::vector<std::string> names;
+  for (long i = 0; i < State.range(0); ++i)
+    names.push_back("f" + std::to_string(i) + "_io");
+
+  for (auto _ : State)
+    for (const auto &name : names)
+      benchmark::DoNotOptimize(list.matches(name));
+
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+
+void BM_GetCxxStreamIOCategories(benchmark::State &State) {
+  const std::vector<std::string> mangled = {
+      "_ZStlsISt11char_traitsIcEERSt13basic_ostreamIcT_ES5_PKc",
+      "_ZNSt13basic_fstreamIcSt11char_traitsIcEEC1EPKcSt13_Ios_Openmode",
+      "_ZNSirsERi", "_ZNSo3putEc",
+      "_ZNSt9basic_iosIcSt11char_traitsIcEE4fillEc",
+      "_ZNSt6vectorIiSaIiEE9push_backERKi"};
+
+  for (auto _ : State)
+    for (long i = 0; i < State.range(0); ++i)
+      benchmark::DoNotOptimize(
+          getCxxStreamIOCategories(mangled[i % mangled.size()]));
+
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+
+// the declarations are classified once per module, before any function is
+// scanned
+void BM_Classify(benchmark::State &State) {
+  llvm::LLVMContext ctx;
+  auto M = generate(ctx, State.range(0));
+  llvm::TargetLibraryInfoImpl TLII(llvm::Triple(M->getTargetTriple()));
+  llvm::TargetLibraryInfo TLI(TLII);
+
+  ApplyIOAttribute aioattr(TLI);
+
+  for (auto _ : State)
+    aioattr.classify(*M);
+
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+}
+
+BENCHMARK(BM_RunOnModule)
+    ->RangeMultiplier(8)
+    ->Range(MinNumFunctions, MaxNumFunctions)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_HasIO)
+    ->RangeMultiplier(8)
+    ->Range(MinNumFunctions, MaxNumFunctions)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_BWListMatches)
+    ->RangeMultiplier(8)
+    ->Ranges({{MinNumFunctions, MaxNumFunctions}, {1, 512}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_BWListRegexMatches)
+    ->RangeMultiplier(8)
+    ->Ranges({{MinNumFunctions, MaxNumFunctions}, {1, 4096}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_GetCxxStreamIOCategories)
+    ->RangeMultiplier(8)
+    ->Range(MinNumFunctions, MaxNumFunctions)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Classify)
+    ->RangeMultiplier(8)
+    ->Range(MinNumFunctions, MaxNumFunctions)
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace anonymous end
+} // namespace icsa end
+
+BENCHMARK_MAIN();
@@ -0,0 +1,129 @@
+//
+//
+//
+
+#include "llvm/IR/LLVMContext.h"
+// using llvm::LLVMContext
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/IRBuilder.h"
+// using llvm::IRBuilder
+
+#include "llvm/IR/Constants.h"
+// using llvm::Constant
+
+#include "llvm/Support/Host.h"
+// using llvm::sys::getDefaultTargetTriple
+
+#include <random>
+// using std::mt19937
+// using std::uniform_int_distribution
+
+#include <string>
+// using std::to_string
+
+#include <vector>
+// using std::vector
+
+#include "SyntheticModule.hpp"
+
+namespace icsa {
+
+namespace {
+
+llvm::Function *declare(llvm::Module &M, const char *Name, llvm::Type *RetTy,
+                        llvm::ArrayRef<llvm::Type *> ParamTys) {
+  auto *funcTy = llvm::FunctionType::get(RetTy, ParamTys, false);
+
+  return llvm::Function::Create(funcTy, llvm::GlobalValue::ExternalLinkage,
+                                Name, &M);
+}
+
+void emitCall(llvm::IRBuilder<> &Builder, llvm::Function *Callee) {
+  std::vector<llvm::Value *> args;
+
+  for (const auto &arg : Callee->args())
+    args.push_back(llvm::Constant::getNullValue(arg.getType()));
+
+  Builder.CreateCall(Callee, args);
+
+  return;
+}
+
+} // namespace anonymous end
+
+std::unique_ptr<llvm::Module>
+generateSyntheticModule(llvm::LLVMContext &Ctx,
+                        const SyntheticModuleConfig &Config) {
+  auto M = std::make_unique<llvm::Module>("synthetic", Ctx);
+  M->setTargetTriple(llvm::sys::getDefaultTargetTriple());
+
+  auto *voidTy = llvm::Type::getVoidTy(Ctx);
+  auto *i8Ty = llvm::Type::getInt8Ty(Ctx);
+  auto *i32Ty = llvm::Type::getInt32Ty(Ctx);
+  auto *i64Ty = llvm::Type::getInt64Ty(Ctx);
+  auto *i8PtrTy = llvm::Type::getInt8PtrTy(Ctx);
+
+  const std::vector<llvm::Function *> libCIOFuncs = {
+      declare(*M, "puts", i32Ty, {i8PtrTy}),
+      declare(*M, "putchar", i32Ty, {i32Ty}),
+      declare(*M, "fwrite", i64Ty, {i8PtrTy, i64Ty, i64Ty, i8PtrTy})};
+
+  const std::vector<llvm::Function *> cxxIOFuncs = {
+      declare(*M, "_ZNSo3putEc", i8PtrTy, {i8PtrTy, i8Ty}),
+      declare(*M, "_ZNSo5flushEv", i8PtrTy, {i8PtrTy}),
+      declare(*M, "_ZNSirsERi", i8PtrTy, {i8PtrTy, i8PtrTy})};
+
+  const std::vector<llvm::Function *> nonIOFuncs = {
+      declare(*M, "strlen", i64Ty, {i8PtrTy}),
+      declare(*M, "malloc", i8PtrTy, {i64Ty}),
+      declare(*M, "_ZNSt9basic_iosIcSt11char_traitsIcEE4fillEc", i8Ty,
+              {i8PtrTy, i8Ty})};
+
+  std::vector<llvm::Function *> funcs;
+  funcs.reserve(Config.NumFunctions);
+
+  auto *funcTy = llvm::FunctionType::get(voidTy, false);
+  for (unsigned i = 0; i < Config.NumFunctions; ++i)
+    funcs.push_back(llvm::Function::Create(
+        funcTy, llvm::GlobalValue::ExternalLinkage, "f" + std::to_string(i),
+        M.get()));
+
+  std::mt19937 rng(Config.Seed);
+  std::uniform_int_distribution<unsigned> percent(0, 99);
+  auto pick = [&rng](const std::vector<llvm::Function *> &Funcs) {
+    std::uniform_int_distribution<std::size_t> dist(0, Funcs.size() - 1);
+
+    return Funcs[dist(rng)];
+  };
+
+  llvm::IRBuilder<> builder(Ctx);
+
+  for (auto *func : funcs) {
+    builder.SetInsertPoint(llvm::BasicBlock::Create(Ctx, "entry", func));
+
+    for (unsigned i = 0; i < Config.CallsPerFunction; ++i) {
+      auto p = percent(rng);
+
+      if (p < Config.LibCIOPercent)
+        emitCall(builder, pick(libCIOFuncs));
+      else if ((p -= Config.LibCIOPercent) < Config.CxxIOPercent)
+        emitCall(builder, pick(cxxIOFuncs));
+      else if ((p -= Config.CxxIOPercent) < Config.LocalCallPercent)
+        emitCall(builder, pick(funcs));
+      else
+        emitCall(builder, pick(nonIOFuncs));
+    }
+
+    builder.CreateRetVoid();
+  }
+
+  return M;
+}
+
+} // namespace icsa end
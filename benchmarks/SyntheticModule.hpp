@@ -0,0 +1,35 @@
+//
+//
+//
+
+#ifndef SYNTHETICMODULE_HPP
+#define SYNTHETICMODULE_HPP
+
+#include <memory>
+// using std::unique_ptr
+
+namespace llvm {
+class LLVMContext;
+class Module;
+} // namespace llvm end
+
+namespace icsa {
+
+struct SyntheticModuleConfig {
+  unsigned NumFunctions = 1000;
+  unsigned CallsPerFunction = 8;
+  // percentages of call sites calling a libc IO or a C++ stream function;
+  // the rest call non-IO library functions or other generated functions
+  unsigned LibCIOPercent = 5;
+  unsigned CxxIOPercent = 5;
+  unsigned LocalCallPercent = 20;
+  unsigned Seed = 42;
+};
+
+std::unique_ptr<llvm::Module>
+generateSyntheticModule(llvm::LLVMContext &Ctx,
+                        const SyntheticModuleConfig &Config);
+
+} // namespace icsa end
+
+#endif // SYNTHETICMODULE_HPP
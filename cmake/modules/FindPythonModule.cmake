@@ -12,7 +12,7 @@ function(find_python_module name)
   # a module's location is usually a directory,
   # but for binary modules it's a .so file
   set(prg_str "import re, ${name}; \
-  print re.compile('/__init__.py.*').sub('',${name}.__file__)")
+  print(re.compile('/__init__.py.*').sub('',${name}.__file__))")
 
   if(PYTHONINTERP_FOUND)
     execute_process(COMMAND ${PYTHON_EXECUTABLE} -c "${prg_str}"
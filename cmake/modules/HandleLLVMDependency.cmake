@@ -13,6 +13,13 @@ macro(handle_llvm_dependency isStandaloneBuild)
     message(STATUS "Using LLVMConfig.cmake in: ${LLVM_DIR}")
   endif()
 
+  # the sources use the call base, pass plugin and per-function target library
+  # info APIs, and the tests use typed pointers
+  if(LLVM_PACKAGE_VERSION VERSION_LESS "12.0.0" OR
+      NOT LLVM_PACKAGE_VERSION VERSION_LESS "15.0.0")
+    message(FATAL_ERROR "LLVM 12 to 14 is required, found ${LLVM_PACKAGE_VERSION}")
+  endif()
+
   if(LLVM_PACKAGE_VERSION VERSION_LESS "3.8.0")
     set(LLVM_RUNTIME_OUTPUT_INTDIR "${CMAKE_BINARY_DIR}/bin/${CMAKE_CFG_INT_DIR}")
     set(LLVM_RUNTIME_OUTPUT_INTDIR "${CMAKE_BINARY_DIR}/lib/${CMAKE_CFG_INT_DIR}")
@@ -13,58 +13,232 @@
 #include <string>
 // using std::string
 
-#include <vector>
-// using std::vector
+#include <atomic>
+// using std::atomic
 
-#include <set>
-// using std::set
+#include <cstdint>
+// using uint64_t
 
 #include "llvm/ADT/StringRef.h"
 // using llvm::StringRef
 
+#include "llvm/ADT/DenseMap.h"
+// using llvm::DenseMap
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+// using llvm::SmallVectorImpl
+
+#include "llvm/ADT/SmallPtrSet.h"
+// using llvm::SmallPtrSetImpl
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "IOCategory.hpp"
+// using icsa::IOCategory
+
+#include "IOCatalog.hpp"
+// using icsa::IOCatalogVersion
+
 namespace llvm {
+class Module;
 class Instruction;
+class CallBase;
+class BasicBlock;
 class Loop;
+class LoopInfo;
 class Function;
 class FunctionType;
+class CallGraph;
 } // namespace llvm end
 
 namespace icsa {
 
+enum class IOKind : int { NONE, LIBC, CXX_STREAM, IMPORTED };
+
+llvm::StringRef getIOKindName(IOKind Kind);
+
+// the call site that caused an IO verdict
+struct IOTrigger {
+  const llvm::Instruction *Site = nullptr;
+  const llvm::Function *Callee = nullptr;
+  IOKind Kind = IOKind::NONE;
+};
+
+// maps functions to their IO category bitmask
+using FunctionIOMap = llvm::DenseMap<const llvm::Function *, unsigned>;
+using LoopIOMap = llvm::DenseMap<const llvm::Loop *, bool>;
+// maps the functions proven IO-free to whether they are also proven not to
+// synchronize with other threads
+using FunctionNoIOMap = llvm::DenseMap<const llvm::Function *, bool>;
+// maps function types to the address-taken functions of that type
+using IndirectCalleeMap =
+    llvm::DenseMap<const llvm::FunctionType *,
+                   llvm::SmallVector<const llvm::Function *, 4>>;
+// maps functions to their IO call sites
+using FunctionIOSiteMap =
+    llvm::DenseMap<const llvm::Function *,
+                   llvm::SmallVector<const llvm::Instruction *, 4>>;
+
 class ApplyIOAttribute {
 public:
   ApplyIOAttribute(const llvm::TargetLibraryInfo &TLI,
-                   llvm::StringRef IOAttr = "icsa-io")
-      : m_IOAttr{IOAttr}, m_TLI{TLI} {
-    setupLibCIOFuncs();
-    setupCxxIOFuncs();
+                   llvm::StringRef IOAttr = "icsa-io",
+                   llvm::StringRef NoIOAttr = "icsa-noio")
+      : m_TLI{TLI}, m_IOAttr{IOAttr}, m_NoIOAttr{NoIOAttr} {}
 
-    return;
-  }
+  // classifies all function declarations of the module once, so that call
+  // sites can be checked with a single lookup, and indexes the address-taken
+  // functions by type, so that indirect calls can be resolved
+  void classify(const llvm::Module &M);
 
+  // classifies the direct callees of a single function and resolves its
+  // indirect calls over a module index, which has to outlive this object, so
+  // that the whole module is not visited for each function
+  void classify(const llvm::Function &F, const IndirectCalleeMap &Callees);
+
+  static void indexIndirectCallees(const llvm::Module &M,
+                                   IndirectCalleeMap &Callees);
+
+  bool hasIO(const llvm::BasicBlock &BB) const;
   bool hasIO(const llvm::Function &Func) const;
+  bool hasIO(const llvm::BasicBlock &BB, IOTrigger &Trigger) const;
+  bool hasIO(const llvm::Function &Func, IOTrigger &Trigger) const;
   bool hasIO(const llvm::Loop &L) const;
-  bool apply(llvm::Function &func) const;
+
+  // unlike hasIO, these visit every call site in order to collect all the
+  // categories of IO; the trigger is the first IO call site
+  unsigned getIOCategories(const llvm::BasicBlock &BB,
+                           IOTrigger &Trigger) const;
+  unsigned getIOCategories(const llvm::Function &Func,
+                           IOTrigger &Trigger) const;
+  unsigned getIOCategories(const llvm::Function &Func) const;
+  unsigned getIOCategories(llvm::ArrayRef<const llvm::Instruction *> Sites,
+                           IOTrigger &Trigger) const;
+
+  // finds the IO call sites of the whole module by visiting the users of the
+  // IO declarations only, instead of every instruction; it requires
+  // classify() and fails when an IO declaration has its address taken, even
+  // if only by a cast, since the indirect calls that may reach it are not
+  // among its users
+  bool collectIOSites(const llvm::Module &M, FunctionIOSiteMap &IOSites) const;
+
+  // computes the verdict of every loop in the nest rooted at L, reusing the
+  // verdicts of inner loops for their parents
+  bool hasIO(const llvm::Loop &L, const llvm::LoopInfo &LI,
+             LoopIOMap &LoopSummaries) const;
+
+  // computes the verdict of every loop of a function from its collected IO
+  // call sites, marking the loops that contain a site and their parents
+  void hasIO(const llvm::LoopInfo &LI,
+             llvm::ArrayRef<const llvm::Instruction *> Sites,
+             LoopIOMap &LoopSummaries) const;
+
+  // computes the transitive IO categories of every defined function by
+  // visiting the strongly connected components of the call graph bottom-up;
+  // the local categories are taken from LocalSummaries when it is given,
+  // instead of scanning each function
+  void propagate(const llvm::CallGraph &CG, FunctionIOMap &IOSummaries,
+                 const FunctionIOMap *LocalSummaries = nullptr) const;
+
+  // proves the absence of IO bottom-up over the call graph; unlike the IO
+  // verdict, which treats unknown callees as IO-free, a function is proven
+  // IO-free only when every callee is a known non-IO library function, an
+  // intrinsic, or itself proven IO-free
+  void proveNoIO(const llvm::CallGraph &CG, FunctionNoIOMap &NoIOFuncs) const;
+
+  // the categories are stored as the decimal value of the attribute; when
+  // they are not known, all categories are assumed
+  bool apply(llvm::Function &func, unsigned Categories = IOC_ALL) const;
+
+  // also adds nosync when it was proven along with the absence of IO
+  bool applyNoIO(llvm::Function &func, bool NoSync) const;
+
+  // marks a function that was not analyzed, e.g. for exceeding the analysis
+  // budget, which conservatively gets all categories of IO
+  bool applyIOUnknown(llvm::Function &func) const;
+
+  // collects the possible targets of the indirect calls of a function, i.e.
+  // the address-taken functions of the module with a matching type
+  void getIndirectCallees(
+      const llvm::Function &Func,
+      llvm::SmallVectorImpl<const llvm::Function *> &Callees) const;
+
+  // tags the loop id metadata with either icsa.io or icsa.noio
+  bool apply(llvm::Loop &L, bool HasIO) const;
+
+  // the estimated IO calls per invocation are stored as a decimal string
+  // attribute; the IO calls counted by a profile, when there is one, are
+  // stored as well
+  bool applyIOFrequency(llvm::Function &func, double Frequency,
+                        const uint64_t *Count = nullptr) const;
+
+  // tags the loop id metadata with the estimated IO calls of the loop per
+  // invocation of its function
+  bool applyIOFrequency(llvm::Loop &L, double Frequency) const;
+
+  // collects the IO call sites of a function in instruction order
+  void getIOSites(const llvm::Function &Func,
+                  llvm::SmallVectorImpl<const llvm::Instruction *> &Sites) const;
+
   inline llvm::StringRef getIOAttr() const { return m_IOAttr; }
+  inline llvm::StringRef getNoIOAttr() const { return m_NoIOAttr; }
+  inline std::string getIOFrequencyAttr() const {
+    return (m_IOAttr + "-freq").str();
+  }
+  inline std::string getIOCountAttr() const {
+    return (m_IOAttr + "-count").str();
+  }
+  inline std::string getIOUnknownAttr() const {
+    return (m_IOAttr + "-unknown").str();
+  }
 
-private:
-  bool hasCIO(const llvm::Function &Func) const;
-  bool hasCxxIO(const llvm::Function &Func) const;
+  inline unsigned long getNumClassificationHits() const {
+    return m_NumClassificationHits;
+  }
 
-  llvm::Function *getCalledFunction(const llvm::Instruction &Inst) const;
-  llvm::Type *getClassFromMethod(const llvm::FunctionType &FuncType) const;
-  std::string demangleCxxName(const char *name) const;
+  inline unsigned long getNumClassificationMisses() const {
+    return m_NumClassificationMisses;
+  }
 
-  void setupLibCIOFuncs();
-  void setupCxxIOFuncs();
+private:
+  struct IOClass {
+    IOKind Kind = IOKind::NONE;
+    unsigned Categories = IOC_NONE;
+  };
+
+  IOClass getIOClass(const llvm::Function &Func) const;
+  IOClass classifyDeclaration(const llvm::Function &Func) const;
+  unsigned getCIOCategories(const llvm::Function &Func) const;
+  unsigned getCxxIOCategories(const llvm::Function &Func) const;
+  unsigned getAppliedIOCategories(const llvm::Function &Func) const;
+
+  // classifies any kind of call site; the callee is the declaration that
+  // caused the classification
+  IOClass getCallSiteIOClass(const llvm::Instruction &Inst,
+                             const llvm::Function *&Callee) const;
+  const llvm::SmallVectorImpl<const llvm::Function *> *
+  getIndirectCallees(const llvm::Instruction &Inst) const;
+
+  // checks a callee of an IO-free candidate; the members of the candidate's
+  // call graph component are assumed IO-free
+  bool isNoIOCallee(const llvm::CallBase &Call, const llvm::Function &Callee,
+                    const llvm::SmallPtrSetImpl<const llvm::Function *> &SCC,
+                    const FunctionNoIOMap &NoIOFuncs, bool &NoSync) const;
 
   const llvm::TargetLibraryInfo &m_TLI;
-  std::set<llvm::LibFunc::Func> m_IOLibFuncs;
 
-  std::vector<std::string> m_CxxIOFuncs;
-  std::vector<std::string> m_CxxIOTypes;
+  llvm::DenseMap<const llvm::Function *, IOClass> m_IODecls;
+  IndirectCalleeMap m_IndirectCallees;
+  // either the own index or the one given for a single function
+  const IndirectCalleeMap *m_IndirectCalleeIndex = &m_IndirectCallees;
+  // functions may be analyzed concurrently
+  mutable std::atomic<unsigned long> m_NumClassificationHits{0};
+  mutable std::atomic<unsigned long> m_NumClassificationMisses{0};
 
   const llvm::StringRef m_IOAttr;
+  const llvm::StringRef m_NoIOAttr;
 };
 
 } // namespace icsa end
@@ -0,0 +1,95 @@
+//
+//
+//
+
+#ifndef APPLYIOATTRIBUTEANALYSIS_HPP
+#define APPLYIOATTRIBUTEANALYSIS_HPP
+
+#include "llvm/IR/PassManager.h"
+// using llvm::AnalysisInfoMixin
+// using llvm::PassInfoMixin
+// using llvm::FunctionAnalysisManager
+// using llvm::ModuleAnalysisManager
+// using llvm::PreservedAnalyses
+
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
+#include "ApplyIOAttribute.hpp"
+// using icsa::IndirectCalleeMap
+
+namespace llvm {
+class Module;
+class Function;
+} // namespace llvm end
+
+namespace icsa {
+
+// new pass manager module analysis indexing the address-taken functions by
+// type, so that the indirect calls of each function are resolved without
+// visiting the whole module per function
+class IndirectCalleeAnalysis
+    : public llvm::AnalysisInfoMixin<IndirectCalleeAnalysis> {
+  friend llvm::AnalysisInfoMixin<IndirectCalleeAnalysis>;
+  static llvm::AnalysisKey Key;
+
+public:
+  class Result {
+  public:
+    const IndirectCalleeMap &getCallees() const { return m_Callees; }
+
+    bool invalidate(llvm::Module &M, const llvm::PreservedAnalyses &PA,
+                    llvm::ModuleAnalysisManager::Invalidator &Inv);
+
+  private:
+    friend IndirectCalleeAnalysis;
+
+    IndirectCalleeMap m_Callees;
+  };
+
+  Result run(llvm::Module &M, llvm::ModuleAnalysisManager &MAM);
+};
+
+// new pass manager analysis caching the IO categories of a function, so that
+// subsequent passes can query them without rescanning the function body
+class ApplyIOAttributeAnalysis
+    : public llvm::AnalysisInfoMixin<ApplyIOAttributeAnalysis> {
+  friend llvm::AnalysisInfoMixin<ApplyIOAttributeAnalysis>;
+  static llvm::AnalysisKey Key;
+
+public:
+  class Result {
+  public:
+    explicit Result(unsigned Categories) : m_Categories{Categories} {}
+
+    bool hasIO() const { return m_Categories; }
+    unsigned getIOCategories() const { return m_Categories; }
+
+    bool invalidate(llvm::Function &F, const llvm::PreservedAnalyses &PA,
+                    llvm::FunctionAnalysisManager::Invalidator &Inv);
+
+  private:
+    unsigned m_Categories;
+  };
+
+  Result run(llvm::Function &F, llvm::FunctionAnalysisManager &FAM);
+};
+
+// new pass manager module transform that applies the IO attribute to every
+// function for which the analysis reports IO
+class ApplyIOAttributeTransform
+    : public llvm::PassInfoMixin<ApplyIOAttributeTransform> {
+public:
+  explicit ApplyIOAttributeTransform(llvm::StringRef IOAttr = "icsa-io")
+      : m_IOAttr{IOAttr} {}
+
+  llvm::PreservedAnalyses run(llvm::Module &M,
+                              llvm::ModuleAnalysisManager &MAM);
+
+private:
+  llvm::StringRef m_IOAttr;
+};
+
+} // namespace icsa end
+
+#endif // APPLYIOATTRIBUTEANALYSIS_HPP
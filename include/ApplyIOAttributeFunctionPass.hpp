@@ -0,0 +1,43 @@
+//
+//
+//
+
+#ifndef APPLYIOATTRIBUTEFUNCTIONPASS_HPP
+#define APPLYIOATTRIBUTEFUNCTIONPASS_HPP
+
+#include "llvm/Pass.h"
+// using llvm::FunctionPass
+
+#include <memory>
+// using std::unique_ptr
+
+#include "ApplyIOAttribute.hpp"
+
+namespace llvm {
+class Module;
+class Function;
+} // namespace llvm end
+
+namespace icsa {
+
+// function pass form of the local analysis, which can be pipelined with other
+// function passes; the declarations of a module are classified once, when its
+// first function is visited
+class ApplyIOAttributeFunctionPass : public llvm::FunctionPass {
+public:
+  static char ID;
+
+  ApplyIOAttributeFunctionPass() : llvm::FunctionPass(ID) {}
+
+  bool doInitialization(llvm::Module &M) override;
+  bool doFinalization(llvm::Module &M) override;
+  void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+  bool runOnFunction(llvm::Function &F) override;
+
+private:
+  std::unique_ptr<ApplyIOAttribute> m_AIOAttr;
+};
+
+} // namespace icsa end
+
+#endif // APPLYIOATTRIBUTEFUNCTIONPASS_HPP
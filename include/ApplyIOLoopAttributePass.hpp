@@ -0,0 +1,42 @@
+//
+//
+//
+
+#ifndef APPLYIOLOOPATTRIBUTEPASS_HPP
+#define APPLYIOLOOPATTRIBUTEPASS_HPP
+
+#include "llvm/Pass.h"
+// using llvm::FunctionPass
+
+#include <memory>
+// using std::unique_ptr
+
+#include "ApplyIOAttribute.hpp"
+
+namespace llvm {
+class Module;
+class Function;
+} // namespace llvm end
+
+namespace icsa {
+
+// the declarations of a module are classified once, when its first function
+// is visited
+class ApplyIOLoopAttributePass : public llvm::FunctionPass {
+public:
+  static char ID;
+
+  ApplyIOLoopAttributePass() : llvm::FunctionPass(ID) {}
+
+  bool doInitialization(llvm::Module &M) override;
+  bool doFinalization(llvm::Module &M) override;
+  void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+  bool runOnFunction(llvm::Function &F) override;
+
+private:
+  std::unique_ptr<ApplyIOAttribute> m_AIOAttr;
+};
+
+} // namespace icsa end
+
+#endif // APPLYIOLOOPATTRIBUTEPASS_HPP
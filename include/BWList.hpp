@@ -13,8 +13,20 @@
 
 #include <vector>
 
+#include <unordered_set>
+
+#include <cstring>
+
+#include <algorithm>
+
 #include <iostream>
 
+#include <bitset>
+
+#include <cctype>
+
+#include "BWListDFA.hpp"
+
 class BWList {
 public:
   enum class ListMode : int { CONJUNCTIVE, DISJUNCTIVE };
@@ -34,8 +46,16 @@ public:
     return file.eof() || file.good();
   }
 
+  // in disjunctive mode, plain names and plain names followed by ".*" are
+  // stored in a hashed set and a prefix trie, so that long generated lists do
+  // not cost a regex run per pattern; only the rest become regexes
   bool addRegex(const char *pattern) {
+    if (ListMode::DISJUNCTIVE == m_Mode && addLiteral(pattern))
+      return true;
+
     m_Patterns.emplace_back(pattern);
+    m_Sources.emplace_back(pattern);
+    m_IsCompiled = false;
     return true;
   }
 
@@ -44,6 +64,46 @@ public:
     return true;
   }
 
+  // in disjunctive mode, merges all patterns into a single automaton, so
+  // that a target costs one pass over its characters whatever the pattern
+  // count; the patterns the automaton does not support, e.g. with
+  // back-references, are still matched one by one
+  //
+  // conjunctive lists are matched pattern by pattern, after checking targets
+  // against the literal leading character that all patterns have to share
+  bool compile() {
+    m_LeadChars.reset();
+    m_HasLeadFilter = false;
+    m_DFA.clear();
+    m_Fallbacks.clear();
+    m_IsCompiled = !m_Sources.empty();
+
+    if (!m_IsCompiled)
+      return false;
+
+    if (ListMode::DISJUNCTIVE == m_Mode) {
+      for (std::size_t i = 0; i < m_Sources.size(); ++i)
+        if (!m_DFA.addPattern(m_Sources[i]))
+          m_Fallbacks.push_back(i);
+
+      return true;
+    }
+
+    m_HasLeadFilter = true;
+
+    for (const auto &src : m_Sources) {
+      char lead = 0;
+      if (getLiteralLead(src, lead))
+        m_LeadChars.set(static_cast<unsigned char>(lead));
+      else
+        m_HasLeadFilter = false;
+    }
+
+    return true;
+  }
+
+  bool isCompiled() const { return m_IsCompiled; }
+
   bool matches(const char *target) {
     return ListMode::DISJUNCTIVE == m_Mode ? matches_any(target)
                                            : matches_all(target);
@@ -51,10 +111,189 @@ public:
 
   bool matches(const std::string &target) { return matches(target.c_str()); }
 
+  std::size_t getNumRegexes() const { return m_Patterns.size(); }
+
 private:
+  // the trie is kept in a single vector; the children of a node are chained
+  // through their next sibling
+  struct TrieNode {
+    unsigned FirstChild = 0;
+    unsigned NextSibling = 0;
+    char Label = 0;
+    bool IsTerminal = false;
+  };
+
+  // tells apart the patterns that match only one name, or only the names
+  // with a given prefix, and unescapes them
+  static bool parseLiteral(const char *pattern, std::string &literal,
+                           bool &isPrefix) {
+    static const char *metaChars = "^$\\.*+?()[]{}|";
+    const auto size = std::strlen(pattern);
+
+    literal.clear();
+    isPrefix = false;
+
+    for (std::size_t i = 0; i < size; ++i) {
+      const char c = pattern[i];
+
+      if ('\\' == c) {
+        // escapes such as \d or \1 are character classes or back-references
+        if (i + 1 == size ||
+            std::isalnum(static_cast<unsigned char>(pattern[i + 1])))
+          return false;
+
+        literal += pattern[++i];
+      } else if ('.' == c && i + 2 == size && '*' == pattern[i + 1]) {
+        isPrefix = true;
+
+        return true;
+      } else if (std::strchr(metaChars, c))
+        return false;
+      else
+        literal += c;
+    }
+
+    return true;
+  }
+
+  bool addLiteral(const char *pattern) {
+    std::string literal;
+    bool isPrefix;
+
+    if (!parseLiteral(pattern, literal, isPrefix))
+      return false;
+
+    if (!isPrefix) {
+      m_Names.insert(literal);
+
+      return true;
+    }
+
+    if (m_Trie.empty())
+      m_Trie.emplace_back();
+
+    unsigned node = 0;
+    for (const auto c : literal) {
+      auto child = m_Trie[node].FirstChild;
+      while (child && m_Trie[child].Label != c)
+        child = m_Trie[child].NextSibling;
+
+      if (!child) {
+        child = static_cast<unsigned>(m_Trie.size());
+        m_Trie.emplace_back();
+        m_Trie[child].Label = c;
+        m_Trie[child].NextSibling = m_Trie[node].FirstChild;
+        m_Trie[node].FirstChild = child;
+      }
+
+      node = child;
+    }
+
+    m_Trie[node].IsTerminal = true;
+
+    return true;
+  }
+
+  // like the regex ".*", the rest of a name must not span lines
+  bool matchesPrefix(const char *target) const {
+    if (m_Trie.empty())
+      return false;
+
+    unsigned node = 0;
+    for (const char *cur = target;; ++cur) {
+      if (m_Trie[node].IsTerminal)
+        return !std::strpbrk(cur, "\n\r");
+
+      if (!*cur)
+        return false;
+
+      auto child = m_Trie[node].FirstChild;
+      while (child && m_Trie[child].Label != *cur)
+        child = m_Trie[child].NextSibling;
+
+      if (!child)
+        return false;
+
+      node = child;
+    }
+  }
+
+  static bool isLiteral(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || '_' == c;
+  }
+
+  // returns the position of the closing bracket of the bracket expression
+  // that starts at pos, or the pattern size if it is not closed
+  static std::size_t skipBracket(const std::string &pattern, std::size_t pos) {
+    auto i = pos + 1;
+
+    for (; i < pattern.size() && ']' != pattern[i]; ++i) {
+      if ('\\' == pattern[i]) {
+        ++i;
+      } else if ('[' == pattern[i] && i + 1 < pattern.size() &&
+                 std::strchr(":.=", pattern[i + 1])) {
+        // character classes such as [:alpha:] hold a closing bracket
+        const auto end = pattern.find(std::string{pattern[i + 1], ']'}, i + 2);
+        if (std::string::npos == end)
+          return pattern.size();
+
+        i = end + 1;
+      }
+    }
+
+    return i;
+  }
+
+  static bool getLiteralLead(const std::string &pattern, char &lead) {
+    if (pattern.empty() || !isLiteral(pattern[0]))
+      return false;
+
+    if (pattern.size() > 1 && std::string("?*{").find(pattern[1]) !=
+                                  std::string::npos)
+      return false;
+
+    // a top-level alternation may start with any character
+    int depth = 0;
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+      if ('\\' == pattern[i])
+        ++i;
+      else if ('[' == pattern[i])
+        i = skipBracket(pattern, i);
+      else if ('(' == pattern[i])
+        ++depth;
+      else if (')' == pattern[i])
+        --depth;
+      else if ('|' == pattern[i] && !depth)
+        return false;
+    }
+
+    lead = pattern[0];
+
+    return true;
+  }
+
+  bool passesLeadFilter(const char *target) const {
+    return !m_HasLeadFilter ||
+           m_LeadChars.test(static_cast<unsigned char>(*target));
+  }
+
   bool matches_any(const char *target) {
     std::cmatch match;
 
+    if ((!m_Names.empty() && m_Names.count(target)) || matchesPrefix(target))
+      return true;
+
+    if (m_IsCompiled) {
+      if (m_DFA.matches(target))
+        return true;
+
+      for (const auto i : m_Fallbacks)
+        if (std::regex_match(target, match, m_Patterns[i]))
+          return true;
+
+      return false;
+    }
+
     for (const auto &pat : m_Patterns)
       if (std::regex_match(target, match, pat))
         return true;
@@ -65,6 +304,11 @@ private:
   bool matches_all(const char *target) {
     std::cmatch match;
 
+    // every pattern with a literal lead has to agree on the first character
+    if (m_IsCompiled && m_HasLeadFilter &&
+        (m_LeadChars.count() > 1 || !passesLeadFilter(target)))
+      return false;
+
     for (const auto &pat : m_Patterns)
       if (!std::regex_match(target, match, pat))
         return false;
@@ -74,6 +318,15 @@ private:
 
   const ListMode m_Mode;
   std::vector<std::regex> m_Patterns;
+  std::vector<std::string> m_Sources;
+  std::unordered_set<std::string> m_Names;
+  std::vector<TrieNode> m_Trie;
+
+  bool m_IsCompiled = false;
+  bool m_HasLeadFilter = false;
+  std::bitset<256> m_LeadChars;
+  BWListDFA m_DFA;
+  std::vector<std::size_t> m_Fallbacks;
 };
 
 #endif // ifndef BWLIST_HPP
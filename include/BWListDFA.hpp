@@ -0,0 +1,734 @@
+//
+//
+//
+
+#ifndef BWLISTDFA_HPP
+#define BWLISTDFA_HPP
+
+#include <string>
+
+#include <vector>
+
+#include <map>
+
+#include <bitset>
+
+#include <algorithm>
+
+#include <iterator>
+
+#include <cstring>
+
+#include <cctype>
+
+// matches a target against the union of many patterns with a single pass over
+// its characters; the patterns are merged into one nondeterministic automaton
+// whose deterministic states are built lazily, as targets reach them
+//
+// the supported syntax is the subset of ECMAScript regexes that has no
+// back-references, assertions or word boundaries; the rest is rejected, so
+// that the caller can match it with std::regex
+class BWListDFA {
+public:
+  BWListDFA() { clear(); }
+
+  void clear() {
+    m_States.assign(1, NFAState{});
+    m_States[MatchState].Kind = NFAState::MATCH;
+    m_Sets.clear();
+    m_Starts.clear();
+    m_ClassesStale = true;
+    resetCache();
+
+    return;
+  }
+
+  bool empty() const { return m_Starts.empty(); }
+
+  // returns false and leaves the automaton unchanged when the pattern uses a
+  // construct that is not supported
+  bool addPattern(const std::string &pattern) {
+    Parser parser{pattern};
+    unsigned root;
+
+    if (!parser.parse(root))
+      return false;
+
+    const auto numStates = m_States.size();
+    const auto numSets = m_Sets.size();
+    unsigned start;
+
+    m_PatternBase = numStates;
+    if (!build(parser.m_Nodes, root, MatchState, start)) {
+      m_States.resize(numStates);
+      m_Sets.resize(numSets);
+
+      return false;
+    }
+
+    m_Starts.push_back(start);
+    m_ClassesStale = true;
+    resetCache();
+
+    return true;
+  }
+
+  // the whole target has to match, like std::regex_match
+  bool matches(const char *target) {
+    if (m_Starts.empty())
+      return false;
+
+    if (m_Trans.empty())
+      buildCache();
+
+    auto state = m_Start;
+    for (const char *cur = target; *cur && DeadState != state; ++cur) {
+      const auto cls = m_ByteClass[static_cast<unsigned char>(*cur)];
+      auto next = m_Trans[state * m_NumClasses + cls];
+
+      if (Unknown == next)
+        next = step(state, cls);
+
+      state = next;
+    }
+
+    return m_Accepts[state];
+  }
+
+private:
+  // the match state of the NFA and the dead state of the DFA
+  enum : unsigned { MatchState = 0, DeadState = 0, Unknown = ~0u };
+
+  // bounds the repetition expansion of a single pattern and the memory of the
+  // lazily built states, which are dropped and rebuilt when over the bound
+  enum : unsigned {
+    MaxPatternStates = 1u << 16,
+    MaxRepeat = 1000,
+    MaxDFAStates = 1u << 14
+  };
+
+  using CharSet = std::bitset<256>;
+
+  struct NFAState {
+    enum StateKind : char { MATCH, CHARS, EPSILON };
+
+    StateKind Kind = EPSILON;
+    unsigned Set = 0;
+    unsigned Out = 0;
+    std::vector<unsigned> Outs;
+  };
+
+  struct Node {
+    enum NodeKind : char { EMPTY, CHARS, CONCAT, ALTERNATE, REPEAT };
+
+    NodeKind Kind = EMPTY;
+    CharSet Set;
+    std::vector<unsigned> Children;
+    unsigned Min = 0;
+    unsigned Max = 0;
+    bool IsUnbounded = false;
+  };
+
+  // recursive descent parser that builds the syntax tree of a pattern
+  struct Parser {
+    explicit Parser(const std::string &pattern) : m_Pattern(pattern) {}
+
+    bool parse(unsigned &root) {
+      return parseAlternation(root) && m_Pos == m_Pattern.size();
+    }
+
+    bool atEnd() const { return m_Pos == m_Pattern.size(); }
+    char peek() const { return m_Pattern[m_Pos]; }
+
+    unsigned addNode(Node::NodeKind kind) {
+      m_Nodes.emplace_back();
+      m_Nodes.back().Kind = kind;
+
+      return static_cast<unsigned>(m_Nodes.size() - 1);
+    }
+
+    bool parseAlternation(unsigned &node) {
+      unsigned branch;
+      if (!parseConcatenation(branch))
+        return false;
+
+      if (atEnd() || '|' != peek()) {
+        node = branch;
+
+        return true;
+      }
+
+      node = addNode(Node::ALTERNATE);
+      m_Nodes[node].Children.push_back(branch);
+
+      while (!atEnd() && '|' == peek()) {
+        ++m_Pos;
+
+        if (!parseConcatenation(branch))
+          return false;
+
+        m_Nodes[node].Children.push_back(branch);
+      }
+
+      return true;
+    }
+
+    bool parseConcatenation(unsigned &node) {
+      node = addNode(Node::CONCAT);
+
+      while (!atEnd() && '|' != peek() && ')' != peek()) {
+        unsigned item;
+        if (!parseRepetition(item))
+          return false;
+
+        m_Nodes[node].Children.push_back(item);
+      }
+
+      return true;
+    }
+
+    bool parseRepetition(unsigned &node) {
+      if (!parseAtom(node))
+        return false;
+
+      while (!atEnd()) {
+        unsigned min = 0, max = 0;
+        bool isUnbounded = false;
+        const char c = peek();
+
+        if ('*' == c)
+          isUnbounded = true;
+        else if ('+' == c)
+          min = 1, isUnbounded = true;
+        else if ('?' == c)
+          max = 1;
+        else if ('{' == c) {
+          if (!parseBounds(min, max, isUnbounded))
+            return false;
+        } else
+          break;
+
+        ++m_Pos;
+
+        // laziness does not change what matches the whole target
+        if (!atEnd() && '?' == peek())
+          ++m_Pos;
+
+        if (min > MaxRepeat || max > MaxRepeat)
+          return false;
+
+        const auto repeat = addNode(Node::REPEAT);
+        m_Nodes[repeat].Children.push_back(node);
+        m_Nodes[repeat].Min = min;
+        m_Nodes[repeat].Max = max;
+        m_Nodes[repeat].IsUnbounded = isUnbounded;
+        node = repeat;
+      }
+
+      return true;
+    }
+
+    // leaves the position at the closing brace
+    bool parseBounds(unsigned &min, unsigned &max, bool &isUnbounded) {
+      ++m_Pos;
+
+      if (!parseNumber(min))
+        return false;
+
+      max = min;
+      if (!atEnd() && ',' == peek()) {
+        ++m_Pos;
+
+        if (!atEnd() && '}' == peek())
+          isUnbounded = true;
+        else if (!parseNumber(max) || max < min)
+          return false;
+      }
+
+      return !atEnd() && '}' == peek();
+    }
+
+    bool parseNumber(unsigned &value) {
+      value = 0;
+
+      if (atEnd() || !std::isdigit(static_cast<unsigned char>(peek())))
+        return false;
+
+      for (; !atEnd() && std::isdigit(static_cast<unsigned char>(peek()));
+           ++m_Pos) {
+        value = value * 10 + (peek() - '0');
+
+        if (value > MaxRepeat)
+          return false;
+      }
+
+      return true;
+    }
+
+    bool parseAtom(unsigned &node) {
+      const char c = peek();
+      ++m_Pos;
+
+      switch (c) {
+      case '(':
+        if (!atEnd() && '?' == peek()) {
+          // lookaheads are assertions
+          if (m_Pos + 1 == m_Pattern.size() || ':' != m_Pattern[m_Pos + 1])
+            return false;
+
+          m_Pos += 2;
+        }
+
+        if (!parseAlternation(node) || atEnd())
+          return false;
+
+        ++m_Pos;
+
+        return true;
+      case '[':
+        node = addNode(Node::CHARS);
+
+        return parseBracket(m_Nodes[node].Set);
+      case '.':
+        node = addNode(Node::CHARS);
+        m_Nodes[node].Set.set();
+        m_Nodes[node].Set.reset('\n');
+        m_Nodes[node].Set.reset('\r');
+
+        return true;
+      case '\\': {
+        if (atEnd())
+          return false;
+
+        node = addNode(Node::CHARS);
+
+        return parseEscape(m_Nodes[node].Set);
+      }
+      // the whole target is matched, so the anchors hold at the ends only
+      case '^':
+        node = addNode(Node::EMPTY);
+
+        return 1 == m_Pos;
+      case '$':
+        node = addNode(Node::EMPTY);
+
+        return atEnd();
+      case '*':
+      case '+':
+      case '?':
+      case '{':
+      case '}':
+      case ')':
+      case ']':
+        return false;
+      default:
+        node = addNode(Node::CHARS);
+        m_Nodes[node].Set.set(static_cast<unsigned char>(c));
+
+        return true;
+      }
+    }
+
+    // the escaped character is at the current position
+    bool parseEscape(CharSet &set) {
+      const auto c = static_cast<unsigned char>(peek());
+      ++m_Pos;
+
+      CharSet cls;
+      bool isNegated = std::isupper(c);
+
+      switch (c) {
+      case 'd':
+      case 'D':
+        addClass(cls, [](int ch) { return std::isdigit(ch); });
+        break;
+      case 'w':
+      case 'W':
+        addClass(cls, [](int ch) { return std::isalnum(ch) || '_' == ch; });
+        break;
+      case 's':
+      case 'S':
+        addClass(cls, [](int ch) { return std::isspace(ch); });
+        break;
+      case 'n':
+        cls.set('\n'), isNegated = false;
+        break;
+      case 't':
+        cls.set('\t'), isNegated = false;
+        break;
+      case 'r':
+        cls.set('\r'), isNegated = false;
+        break;
+      case 'f':
+        cls.set('\f'), isNegated = false;
+        break;
+      case 'v':
+        cls.set('\v'), isNegated = false;
+        break;
+      default:
+        // back-references, boundaries and code points are not supported
+        if (std::isalnum(c))
+          return false;
+
+        cls.set(c), isNegated = false;
+      }
+
+      set |= isNegated ? ~cls : cls;
+
+      return true;
+    }
+
+    bool parseBracket(CharSet &set) {
+      bool isNegated = false;
+
+      if (!atEnd() && '^' == peek()) {
+        isNegated = true;
+        ++m_Pos;
+      }
+
+      // an empty bracket matches nothing in ECMAScript but not elsewhere
+      if (atEnd() || ']' == peek())
+        return false;
+
+      while (!atEnd() && ']' != peek()) {
+        int lo;
+        if (!parseBracketItem(set, lo))
+          return false;
+
+        if (lo < 0 || atEnd() || '-' != peek() ||
+            m_Pos + 1 == m_Pattern.size() || ']' == m_Pattern[m_Pos + 1])
+          continue;
+
+        ++m_Pos;
+
+        int hi;
+        if (!parseBracketItem(set, hi) || hi < lo)
+          return false;
+
+        for (auto ch = lo; ch <= hi; ++ch)
+          set.set(ch);
+      }
+
+      if (atEnd())
+        return false;
+
+      ++m_Pos;
+
+      if (isNegated)
+        set.flip();
+
+      return true;
+    }
+
+    // the single character of the item is returned, so that it can start a
+    // range; classes return -1
+    bool parseBracketItem(CharSet &set, int &single) {
+      const auto c = static_cast<unsigned char>(peek());
+      ++m_Pos;
+      single = -1;
+
+      if ('[' == c && !atEnd() && ':' == peek())
+        return parseNamedClass(set);
+
+      // collating elements and equivalence classes are not supported
+      if ('[' == c && !atEnd() && ('.' == peek() || '=' == peek()))
+        return false;
+
+      if ('\\' == c) {
+        if (atEnd())
+          return false;
+
+        const auto escaped = static_cast<unsigned char>(peek());
+
+        // \b is a backspace in a bracket
+        if ('b' == escaped)
+          return false;
+
+        CharSet cls;
+        if (!parseEscape(cls))
+          return false;
+
+        if (1 == cls.count())
+          for (single = 0; !cls.test(single); ++single)
+            ;
+
+        set |= cls;
+
+        return true;
+      }
+
+      set.set(c);
+      single = c;
+
+      return true;
+    }
+
+    bool parseNamedClass(CharSet &set) {
+      ++m_Pos;
+      const auto end = m_Pattern.find(":]", m_Pos);
+      if (std::string::npos == end)
+        return false;
+
+      const auto name = m_Pattern.substr(m_Pos, end - m_Pos);
+      m_Pos = end + 2;
+
+      static const std::map<std::string, int (*)(int)> classes = {
+          {"alnum", std::isalnum}, {"alpha", std::isalpha},
+          {"blank", std::isblank}, {"cntrl", std::iscntrl},
+          {"digit", std::isdigit}, {"graph", std::isgraph},
+          {"lower", std::islower}, {"print", std::isprint},
+          {"punct", std::ispunct}, {"space", std::isspace},
+          {"upper", std::isupper}, {"xdigit", std::isxdigit}};
+
+      const auto found = classes.find(name);
+      if (found == classes.end())
+        return false;
+
+      addClass(set, found->second);
+
+      return true;
+    }
+
+    template <typename PredicateT>
+    static void addClass(CharSet &set, PredicateT predicate) {
+      for (int ch = 0; ch < 256; ++ch)
+        if (predicate(ch))
+          set.set(ch);
+
+      return;
+    }
+
+    const std::string &m_Pattern;
+    std::size_t m_Pos = 0;
+    std::vector<Node> m_Nodes;
+  };
+
+  unsigned addState(NFAState::StateKind kind) {
+    m_States.emplace_back();
+    m_States.back().Kind = kind;
+
+    return static_cast<unsigned>(m_States.size() - 1);
+  }
+
+  // builds the states of a node backwards from the state that follows it,
+  // expanding bounded repetitions into copies of their operand
+  bool build(const std::vector<Node> &nodes, unsigned node, unsigned next,
+             unsigned &start) {
+    if (m_States.size() - m_PatternBase > MaxPatternStates)
+      return false;
+
+    const auto &n = nodes[node];
+
+    switch (n.Kind) {
+    case Node::EMPTY:
+      start = next;
+
+      return true;
+    case Node::CHARS:
+      start = addState(NFAState::CHARS);
+      m_States[start].Out = next;
+      m_States[start].Set = static_cast<unsigned>(m_Sets.size());
+      m_Sets.push_back(n.Set);
+
+      return true;
+    case Node::CONCAT:
+      start = next;
+
+      for (auto ci = n.Children.rbegin(); ci != n.Children.rend(); ++ci)
+        if (!build(nodes, *ci, start, start))
+          return false;
+
+      return true;
+    case Node::ALTERNATE: {
+      std::vector<unsigned> outs;
+
+      for (const auto child : n.Children) {
+        unsigned branch;
+        if (!build(nodes, child, next, branch))
+          return false;
+
+        outs.push_back(branch);
+      }
+
+      start = addState(NFAState::EPSILON);
+      m_States[start].Outs = std::move(outs);
+
+      return true;
+    }
+    case Node::REPEAT: {
+      const auto child = n.Children.front();
+      auto cur = next;
+
+      if (n.IsUnbounded) {
+        const auto loop = addState(NFAState::EPSILON);
+        unsigned body;
+
+        if (!build(nodes, child, loop, body))
+          return false;
+
+        m_States[loop].Outs = {body, next};
+        cur = loop;
+      } else
+        for (auto i = n.Min; i < n.Max; ++i) {
+          unsigned body;
+          if (!build(nodes, child, cur, body))
+            return false;
+
+          const auto skip = addState(NFAState::EPSILON);
+          m_States[skip].Outs = {body, next};
+          cur = skip;
+        }
+
+      for (unsigned i = 0; i < n.Min; ++i)
+        if (!build(nodes, child, cur, cur))
+          return false;
+
+      start = cur;
+
+      return true;
+    }
+    }
+
+    return false;
+  }
+
+  void resetCache() {
+    m_Trans.clear();
+    m_Accepts.clear();
+    m_DFAStates.clear();
+    m_DFAIndex.clear();
+
+    return;
+  }
+
+  // the bytes that no set tells apart share a class, so that the transition
+  // table has a column per class instead of per byte
+  void computeByteClasses() {
+    std::fill(std::begin(m_ByteClass), std::end(m_ByteClass), 0);
+    m_NumClasses = 1;
+
+    // each set splits every class into its bytes inside and outside the set
+    std::vector<unsigned> refined;
+
+    for (const auto &set : m_Sets) {
+      refined.assign(2 * m_NumClasses, Unknown);
+      unsigned numRefined = 0;
+
+      for (int ch = 0; ch < 256; ++ch) {
+        auto &cls = refined[2 * m_ByteClass[ch] + set.test(ch)];
+
+        if (Unknown == cls)
+          cls = numRefined++;
+
+        m_ByteClass[ch] = cls;
+      }
+
+      m_NumClasses = numRefined;
+    }
+
+    for (int ch = 0; ch < 256; ++ch)
+      m_ClassByte[m_ByteClass[ch]] = static_cast<unsigned char>(ch);
+
+    return;
+  }
+
+  void buildCache() {
+    if (!m_NumClasses || m_ClassesStale) {
+      computeByteClasses();
+      m_ClassesStale = false;
+    }
+
+    resetCache();
+
+    // the dead state has no NFA states and loops to itself
+    addDFAState({});
+    std::fill(m_Trans.begin(), m_Trans.end(), static_cast<unsigned>(DeadState));
+
+    m_Start = addDFAState(closure(m_Starts));
+
+    return;
+  }
+
+  std::vector<unsigned> closure(const std::vector<unsigned> &seeds) const {
+    std::vector<unsigned> result;
+    std::vector<char> visited(m_States.size(), false);
+    std::vector<unsigned> stack(seeds.rbegin(), seeds.rend());
+
+    while (!stack.empty()) {
+      const auto s = stack.back();
+      stack.pop_back();
+
+      if (visited[s])
+        continue;
+
+      visited[s] = true;
+
+      if (NFAState::EPSILON == m_States[s].Kind)
+        stack.insert(stack.end(), m_States[s].Outs.rbegin(),
+                     m_States[s].Outs.rend());
+      else
+        result.push_back(s);
+    }
+
+    std::sort(result.begin(), result.end());
+
+    return result;
+  }
+
+  unsigned addDFAState(std::vector<unsigned> states) {
+    const auto found = m_DFAIndex.find(states);
+    if (found != m_DFAIndex.end())
+      return found->second;
+
+    const auto id = static_cast<unsigned>(m_DFAStates.size());
+    m_Accepts.push_back(!states.empty() && MatchState == states.front());
+    m_Trans.resize(m_Trans.size() + m_NumClasses, Unknown);
+    m_DFAIndex.emplace(states, id);
+    m_DFAStates.push_back(std::move(states));
+
+    return id;
+  }
+
+  unsigned step(unsigned state, unsigned cls) {
+    const auto ch = m_ClassByte[cls];
+    std::vector<unsigned> seeds;
+
+    for (const auto s : m_DFAStates[state])
+      if (NFAState::CHARS == m_States[s].Kind &&
+          m_Sets[m_States[s].Set].test(ch))
+        seeds.push_back(m_States[s].Out);
+
+    auto next = closure(seeds);
+
+    // the cache is rebuilt from scratch when it grows over its bound, which
+    // keeps the state being entered
+    if (m_DFAStates.size() >= MaxDFAStates) {
+      buildCache();
+
+      return addDFAState(std::move(next));
+    }
+
+    const auto id = addDFAState(std::move(next));
+    m_Trans[state * m_NumClasses + cls] = id;
+
+    return id;
+  }
+
+  std::vector<NFAState> m_States;
+  std::vector<CharSet> m_Sets;
+  std::vector<unsigned> m_Starts;
+  std::size_t m_PatternBase = 0;
+
+  unsigned m_ByteClass[256] = {};
+  unsigned char m_ClassByte[256] = {};
+  unsigned m_NumClasses = 0;
+  bool m_ClassesStale = true;
+
+  unsigned m_Start = DeadState;
+  std::vector<unsigned> m_Trans;
+  std::vector<char> m_Accepts;
+  std::vector<std::vector<unsigned>> m_DFAStates;
+  std::map<std::vector<unsigned>, unsigned> m_DFAIndex;
+};
+
+#endif // ifndef BWLISTDFA_HPP
@@ -0,0 +1,44 @@
+//
+//
+//
+
+#ifndef COALESCELOOPIOPASS_HPP
+#define COALESCELOOPIOPASS_HPP
+
+#include "llvm/Pass.h"
+// using llvm::FunctionPass
+
+#include <memory>
+// using std::unique_ptr
+
+#include "ApplyIOAttribute.hpp"
+
+namespace llvm {
+class Module;
+class Function;
+} // namespace llvm end
+
+namespace icsa {
+
+// stages the single character writes of a loop to one stream in a buffer and
+// writes it with fwrite when it fills up and when the loop exits; the
+// declarations of a module are classified once, when its first function is
+// visited
+class CoalesceLoopIOPass : public llvm::FunctionPass {
+public:
+  static char ID;
+
+  CoalesceLoopIOPass() : llvm::FunctionPass(ID) {}
+
+  bool doInitialization(llvm::Module &M) override;
+  bool doFinalization(llvm::Module &M) override;
+  void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+  bool runOnFunction(llvm::Function &F) override;
+
+private:
+  std::unique_ptr<ApplyIOAttribute> m_AIOAttr;
+};
+
+} // namespace icsa end
+
+#endif // COALESCELOOPIOPASS_HPP
@@ -0,0 +1,26 @@
+//
+//
+//
+
+#ifndef CXXSTREAMMATCHER_HPP
+#define CXXSTREAMMATCHER_HPP
+
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
+#include "IOCategory.hpp"
+// using icsa::IOCategory
+
+namespace icsa {
+
+// matches Itanium mangled names of the standard stream class methods and of
+// the free stream functions (e.g. operator<<, std::getline) without
+// demangling or allocating memory
+bool matchesCxxStreamIO(llvm::StringRef MangledName);
+
+// returns the IO categories of a matched name, or IOC_NONE otherwise
+unsigned getCxxStreamIOCategories(llvm::StringRef MangledName);
+
+} // namespace icsa end
+
+#endif // CXXSTREAMMATCHER_HPP
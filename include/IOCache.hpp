@@ -0,0 +1,84 @@
+//
+//
+//
+
+#ifndef IOCACHE_HPP
+#define IOCACHE_HPP
+
+#include "llvm/Support/MemoryBuffer.h"
+// using llvm::MemoryBuffer
+
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
+#include <map>
+// using std::map
+
+#include <memory>
+// using std::unique_ptr
+
+#include <string>
+// using std::string
+
+#include <cstdint>
+// using uint64_t
+
+namespace llvm {
+class Function;
+class TargetLibraryInfo;
+} // namespace llvm end
+
+namespace icsa {
+
+// persistent store of the IO categories of ODR functions keyed by a structural
+// hash of their body;
+// the store file is memory-mapped and holds records sorted by key, while new
+// verdicts are merged in and written back atomically
+class IOCache {
+public:
+  explicit IOCache(llvm::StringRef Dir) : m_Dir{Dir} {}
+
+  bool load();
+  bool lookup(uint64_t Key, unsigned &Categories) const;
+  void insert(uint64_t Key, unsigned Categories);
+  bool store();
+
+  // the ODR functions are the ones reanalysed in every translation unit
+  static bool isCacheable(const llvm::Function &Func);
+
+  // the one definition rule holds within a link only, so the key covers the
+  // opcodes and types of the body, and the name, the kind and the target
+  // library availability of each callee, since an edited body must miss
+  static uint64_t getKey(const llvm::Function &Func, unsigned CatalogVersion,
+                         const llvm::TargetLibraryInfo &TLI);
+
+  // the verdict of indirect calls and of calls to declarations with imported
+  // facts depends on the rest of the module, which the key does not capture;
+  // this walks the body and is meant for cache misses only
+  static bool isModuleIndependent(const llvm::Function &Func,
+                                  llvm::StringRef IOAttr);
+
+private:
+  struct Record {
+    uint64_t Key;
+    uint64_t Value;
+  };
+
+  struct Header {
+    char Magic[8];
+    uint32_t Version;
+    uint32_t NumRecords;
+  };
+
+  const Record *records_begin() const;
+  const Record *records_end() const;
+  std::string getFilename() const;
+
+  std::string m_Dir;
+  std::unique_ptr<llvm::MemoryBuffer> m_Buffer;
+  std::map<uint64_t, unsigned> m_NewRecords;
+};
+
+} // namespace icsa end
+
+#endif // IOCACHE_HPP
@@ -0,0 +1,34 @@
+//
+//
+//
+
+#ifndef IOCATALOG_HPP
+#define IOCATALOG_HPP
+
+#include "llvm/Analysis/TargetLibraryInfo.h"
+// using llvm::LibFunc
+
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
+#include "IOCategory.hpp"
+// using icsa::IOCategory
+
+namespace icsa {
+
+// the IO catalog is generated at build time from share/catalog/IOCatalog.txt
+
+// derived from the catalog entries, so that any change to them invalidates
+// persisted verdicts
+extern const unsigned IOCatalogVersion;
+
+// constant time lookup of the IO categories of a library function
+unsigned getLibFuncIOCategories(llvm::LibFunc F);
+
+// constant time lookup of the IO categories of C functions that are not
+// recognized by every supported target library info
+unsigned getNamedIOCategories(llvm::StringRef Name);
+
+} // namespace icsa end
+
+#endif // IOCATALOG_HPP
@@ -0,0 +1,30 @@
+//
+//
+//
+
+#ifndef IOCATEGORY_HPP
+#define IOCATEGORY_HPP
+
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
+namespace icsa {
+
+// the categories of IO are combined into a bitmask that forms the value of
+// the IO attribute
+enum IOCategory : unsigned {
+  IOC_NONE = 0,
+  IOC_CONSOLE = 1u << 0,
+  IOC_FILE_READ = 1u << 1,
+  IOC_FILE_WRITE = 1u << 2,
+  IOC_FS_METADATA = 1u << 3,
+  IOC_PROCESS = 1u << 4,
+  IOC_STREAM_LOCK = 1u << 5,
+  IOC_ALL = (1u << 6) - 1
+};
+
+llvm::StringRef getIOCategoryName(IOCategory Category);
+
+} // namespace icsa end
+
+#endif // IOCATEGORY_HPP
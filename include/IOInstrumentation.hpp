@@ -0,0 +1,50 @@
+//
+//
+//
+
+#ifndef IOINSTRUMENTATION_HPP
+#define IOINSTRUMENTATION_HPP
+
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
+#include <string>
+// using std::string
+
+#include <vector>
+// using std::vector
+
+namespace llvm {
+class Module;
+class Instruction;
+class GlobalVariable;
+} // namespace llvm end
+
+namespace icsa {
+
+// wraps IO call sites with the counting and timing probes of the aioattr
+// runtime; the sites of a module are registered by a module constructor,
+// which receives the process-wide id of the first site
+class IOInstrumentation {
+public:
+  explicit IOInstrumentation(llvm::Module &M) : m_Module(M) {}
+
+  // the end probe of an invoke starts its normal destination, whose edge is
+  // split when the destination has other predecessors; musttail calls
+  // cannot be followed by the end probe, so they are left alone
+  bool instrument(llvm::Instruction &Site, llvm::StringRef Name);
+
+  // emits the site table and its registration
+  bool finalize();
+
+  inline std::size_t getNumSites() const { return m_SiteNames.size(); }
+
+private:
+  llvm::Module &m_Module;
+  llvm::GlobalVariable *m_SiteBase = nullptr;
+  std::vector<std::string> m_SiteNames;
+};
+
+} // namespace icsa end
+
+#endif // IOINSTRUMENTATION_HPP
@@ -0,0 +1,51 @@
+//
+//
+//
+
+#ifndef IOPROFILE_HPP
+#define IOPROFILE_HPP
+
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
+#include <map>
+// using std::map
+
+#include <string>
+// using std::string
+
+#include <utility>
+// using std::pair
+
+#include <vector>
+// using std::vector
+
+#include <cstdint>
+// using uint64_t
+
+namespace icsa {
+
+// reader of the profiles written at exit by the runtime of the
+// -aioattr-instrument mode; the sites of several profiles, e.g. of several
+// runs, are merged by module and site name
+class IOProfile {
+public:
+  struct Site {
+    std::string Module;
+    std::string Name;
+    uint64_t Calls = 0;
+    uint64_t Nanoseconds = 0;
+  };
+
+  bool read(llvm::StringRef Filename);
+
+  inline const std::vector<Site> &getSites() const { return m_Sites; }
+
+private:
+  std::vector<Site> m_Sites;
+  std::map<std::pair<std::string, std::string>, std::size_t> m_Index;
+};
+
+} // namespace icsa end
+
+#endif // IOPROFILE_HPP
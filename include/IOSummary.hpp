@@ -0,0 +1,54 @@
+//
+//
+//
+
+#ifndef IOSUMMARY_HPP
+#define IOSUMMARY_HPP
+
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
+#include <map>
+// using std::map
+
+#include <set>
+// using std::set
+
+#include <vector>
+// using std::vector
+
+#include <cstdint>
+// using uint64_t
+
+namespace icsa {
+
+// per-module summary of IO verdicts keyed by the same global value GUIDs that
+// identify functions in the ThinLTO module summary index; the summaries of all
+// modules are combined during the thin link and the transitive IO facts are
+// handed back to each backend
+class IOSummary {
+public:
+  struct Entry {
+    bool HasIO = false;
+    std::vector<uint64_t> Callees;
+  };
+
+  void add(uint64_t GUID, bool HasIO, std::vector<uint64_t> Callees);
+
+  bool read(llvm::StringRef Filename);
+  bool write(llvm::StringRef Filename) const;
+
+  // computes the GUIDs of all functions that reach IO through any module
+  std::set<uint64_t> resolve() const;
+
+  static bool readFacts(llvm::StringRef Filename, std::set<uint64_t> &Facts);
+  static bool writeFacts(llvm::StringRef Filename,
+                         const std::set<uint64_t> &Facts);
+
+private:
+  std::map<uint64_t, Entry> m_Entries;
+};
+
+} // namespace icsa end
+
+#endif // IOSUMMARY_HPP
@@ -2,6 +2,14 @@
 //
 //
 
+#define DEBUG_TYPE "applyioattribute"
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
 #include "llvm/IR/Function.h"
 // using llvm::Function
 
@@ -11,8 +19,12 @@
 #include "llvm/Analysis/LoopInfo.h"
 // using llvm::Loop
 
-#include "llvm/IR/Type.h"
-// using llvm::Type
+#include "llvm/Analysis/CallGraph.h"
+// using llvm::CallGraph
+// using llvm::CallGraphNode
+
+#include "llvm/ADT/SCCIterator.h"
+// using llvm::scc_begin
 
 #include "llvm/IR/DerivedTypes.h"
 // using llvm::FunctionType
@@ -20,293 +32,872 @@
 #include "llvm/IR/Instruction.h"
 // using llvm::Instruction
 
-#include "llvm/IR/Instructions.h"
-// using llvm::CallInst
+#include "llvm/IR/InstrTypes.h"
+// using llvm::CallBase
 
 #include "llvm/IR/IntrinsicInst.h"
 // using llvm::IntrinsicInst
+// using llvm::MemIntrinsic
+
+#include "llvm/IR/Instructions.h"
+// using llvm::LoadInst
+// using llvm::StoreInst
+
+#include "llvm/IR/Attributes.h"
+// using llvm::Attribute
+
+#include "llvm/IR/Metadata.h"
+// using llvm::MDNode
+// using llvm::MDString
+// using llvm::ConstantAsMetadata
+
+#include "llvm/IR/Constants.h"
+// using llvm::ConstantFP
+
+#include "llvm/IR/Type.h"
+// using llvm::Type
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/ADT/SmallPtrSet.h"
+// using llvm::SmallPtrSet
+
+#include "llvm/ADT/Statistic.h"
+// using STATISTIC macro
+
+#include "llvm/ADT/StringExtras.h"
+// using llvm::utostr
+
+#include "llvm/ADT/STLExtras.h"
+// using llvm::is_contained
+
+#include "llvm/Support/Format.h"
+// using llvm::format
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::raw_string_ostream
 
 #include "llvm/Support/Casting.h"
 // using llvm::dyn_cast
+// using llvm::cast
 
-#include <cxxabi.h>
-// using abi::__cxa_demangle
+#include <vector>
+// using std::vector
 
-#include <cstdlib>
-// using std::free
+#include <utility>
+// using std::pair
 
 #include <algorithm>
-// using std::find_if
+// using std::all_of
+
+#include "CxxStreamMatcher.hpp"
+// using icsa::getCxxStreamIOCategories
 
-#include <memory>
-// using std::unique_ptr
+#include "IOCatalog.hpp"
+// using icsa::getLibFuncIOCategories
+// using icsa::getNamedIOCategories
 
 #include "ApplyIOAttribute.hpp"
 
-template <typename T> struct rm_const_ptr { using type = T; };
-template <typename T> struct rm_const_ptr<const T *> { using type = T *; };
-template <typename T> using rm_const_ptr_t = typename rm_const_ptr<T>::type;
+STATISTIC(NumCallSitesInspected, "Number of call sites inspected");
+STATISTIC(NumIndirectCallSitesResolved,
+          "Number of indirect call sites with candidate callees");
+STATISTIC(NumIODeclUsersVisited,
+          "Number of IO declaration users visited by the use-list engine");
+STATISTIC(NumTLILookups, "Number of target library info lookups");
+STATISTIC(NumCxxNameMatches, "Number of C++ stream name matches");
 
-struct malloc_deleter {
-  template <typename T> void operator()(T *ptr) const { std::free(ptr); }
-};
+namespace icsa {
 
-template <typename T>
-using malloc_unique_ptr = std::unique_ptr<T, malloc_deleter>;
+namespace {
 
-namespace icsa {
+const llvm::StringRef LoopIOTag = "icsa.io";
+const llvm::StringRef LoopNoIOTag = "icsa.noio";
+const llvm::StringRef LoopIOFrequencyTag = "icsa.io.freq";
 
-bool ApplyIOAttribute::hasIO(const llvm::Function &Func) const {
-  for (const auto &bb : Func)
+llvm::StringRef getLoopTag(const llvm::Metadata *MD) {
+  const auto *node = llvm::dyn_cast_or_null<llvm::MDNode>(MD);
+  if (!node || !node->getNumOperands())
+    return "";
+
+  const auto *str = llvm::dyn_cast_or_null<llvm::MDString>(node->getOperand(0));
+
+  return str ? str->getString() : "";
+}
+
+// adds the tag node to the loop id, replacing the operands with any of the
+// replaced tags; returns false when the loop id already has the node
+bool setLoopTag(llvm::Loop &L, llvm::MDNode *TagNode,
+                llvm::ArrayRef<llvm::StringRef> ReplacedTags) {
+  auto &ctx = L.getHeader()->getContext();
+
+  // the first operand of a loop id is a self reference
+  llvm::SmallVector<llvm::Metadata *, 4> mds;
+  mds.push_back(nullptr);
+
+  if (auto *loopID = L.getLoopID())
+    for (unsigned i = 1, e = loopID->getNumOperands(); i < e; ++i) {
+      auto *op = loopID->getOperand(i).get();
+
+      if (op == TagNode)
+        return false;
+
+      if (!llvm::is_contained(ReplacedTags, getLoopTag(op)))
+        mds.push_back(op);
+    }
+
+  mds.push_back(TagNode);
+
+  auto *newLoopID = llvm::MDNode::getDistinct(ctx, mds);
+  newLoopID->replaceOperandWith(0, newLoopID);
+  L.setLoopID(newLoopID);
+
+  return true;
+}
+
+// conservatively, any atomic or volatile access may synchronize
+bool maySync(const llvm::Instruction &Inst) {
+  if (Inst.isAtomic())
+    return true;
+
+  if (const auto *load = llvm::dyn_cast<llvm::LoadInst>(&Inst))
+    return load->isVolatile();
+
+  if (const auto *store = llvm::dyn_cast<llvm::StoreInst>(&Inst))
+    return store->isVolatile();
+
+  if (const auto *memInst = llvm::dyn_cast<llvm::MemIntrinsic>(&Inst))
+    return memInst->isVolatile();
+
+  return false;
+}
+
+// a library function that is handed a function, such as the comparator of
+// qsort, may call it and perform IO through it; with opaque pointers, any
+// pointer may be a function
+bool mayCallBack(const llvm::CallBase &Call) {
+  for (const auto &arg : Call.args()) {
+    if (llvm::isa<llvm::Function>(arg->stripPointerCasts()))
+      return true;
+
+    const auto *type = arg->getType();
+    if (!type->isPointerTy())
+      continue;
+
+#if LLVM_VERSION_MAJOR >= 13
+    if (type->isOpaquePointerTy())
+      return true;
+#endif
+
+    if (type->getPointerElementType()->isFunctionTy())
+      return true;
+  }
+
+  return false;
+}
+
+} // namespace anonymous end
+
+llvm::StringRef getIOKindName(IOKind Kind) {
+  switch (Kind) {
+  case IOKind::LIBC:
+    return "libc";
+  case IOKind::CXX_STREAM:
+    return "c++ stream";
+  case IOKind::IMPORTED:
+    return "imported";
+  default:
+    return "none";
+  }
+}
+
+llvm::StringRef getIOCategoryName(IOCategory Category) {
+  switch (Category) {
+  case IOC_CONSOLE:
+    return "console";
+  case IOC_FILE_READ:
+    return "file read";
+  case IOC_FILE_WRITE:
+    return "file write";
+  case IOC_FS_METADATA:
+    return "filesystem metadata";
+  case IOC_PROCESS:
+    return "process";
+  case IOC_STREAM_LOCK:
+    return "stream lock";
+  default:
+    return "none";
+  }
+}
+
+void ApplyIOAttribute::classify(const llvm::Module &M) {
+  m_IODecls.clear();
+  m_IndirectCalleeIndex = &m_IndirectCallees;
+
+  for (const auto &func : M)
+    if (func.isDeclaration() && !func.isIntrinsic())
+      m_IODecls[&func] = classifyDeclaration(func);
+
+  indexIndirectCallees(M, m_IndirectCallees);
+
+  return;
+}
+
+void ApplyIOAttribute::classify(const llvm::Function &F,
+                                const IndirectCalleeMap &Callees) {
+  m_IODecls.clear();
+  m_IndirectCalleeIndex = &Callees;
+
+  for (const auto &bb : F)
     for (const auto &inst : bb) {
-      const auto *calledFunc = getCalledFunction(inst);
-      if (calledFunc)
-        return hasCIO(*calledFunc) || hasCxxIO(*calledFunc);
+      const auto *call = llvm::dyn_cast<llvm::CallBase>(&inst);
+      if (!call)
+        continue;
+
+      const auto *callee = llvm::dyn_cast<llvm::Function>(
+          call->getCalledOperand()->stripPointerCasts());
+      if (callee && callee->isDeclaration() && !callee->isIntrinsic() &&
+          !m_IODecls.count(callee))
+        m_IODecls[callee] = classifyDeclaration(*callee);
     }
 
+  return;
+}
+
+void ApplyIOAttribute::indexIndirectCallees(const llvm::Module &M,
+                                            IndirectCalleeMap &Callees) {
+  Callees.clear();
+
+  for (const auto &func : M)
+    if (func.hasAddressTaken())
+      Callees[func.getFunctionType()].push_back(&func);
+
+  return;
+}
+
+bool ApplyIOAttribute::hasIO(const llvm::BasicBlock &BB) const {
+  IOTrigger trigger;
+
+  return hasIO(BB, trigger);
+}
+
+bool ApplyIOAttribute::hasIO(const llvm::Function &Func) const {
+  IOTrigger trigger;
+
+  return hasIO(Func, trigger);
+}
+
+bool ApplyIOAttribute::hasIO(const llvm::BasicBlock &BB,
+                             IOTrigger &Trigger) const {
+  for (const auto &inst : BB) {
+    const llvm::Function *calledFunc = nullptr;
+
+    const auto ioClass = getCallSiteIOClass(inst, calledFunc);
+    if (ioClass.Kind != IOKind::NONE) {
+      Trigger.Site = &inst;
+      Trigger.Callee = calledFunc;
+      Trigger.Kind = ioClass.Kind;
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool ApplyIOAttribute::hasIO(const llvm::Function &Func,
+                             IOTrigger &Trigger) const {
+  for (const auto &bb : Func)
+    if (hasIO(bb, Trigger))
+      return true;
+
   return false;
 }
 
 bool ApplyIOAttribute::hasIO(const llvm::Loop &L) const {
   for (auto bbi = L.block_begin(), bbe = L.block_end(); bbi != bbe; ++bbi)
-    for (const auto &inst : **bbi) {
-      const auto *calledFunc = getCalledFunction(inst);
-      if (calledFunc)
-        return hasCIO(*calledFunc) || hasCxxIO(*calledFunc);
-    }
+    if (hasIO(**bbi))
+      return true;
 
   return false;
 }
 
-bool ApplyIOAttribute::apply(llvm::Function &func) const {
-  func.addFnAttr(this->getIOAttr());
+bool ApplyIOAttribute::hasIO(const llvm::Loop &L, const llvm::LoopInfo &LI,
+                             LoopIOMap &LoopSummaries) const {
+  bool loopHasIO = false;
+
+  // all subloops are visited even after IO is found, so that the whole nest
+  // gets a verdict
+  for (const auto *subLoop : L.getSubLoops())
+    loopHasIO |= hasIO(*subLoop, LI, LoopSummaries);
+
+  // scan only the blocks that do not belong to a subloop
+  for (auto bbi = L.block_begin(), bbe = L.block_end();
+       !loopHasIO && bbi != bbe; ++bbi)
+    if (LI.getLoopFor(*bbi) == &L)
+      loopHasIO = hasIO(**bbi);
+
+  LoopSummaries[&L] = loopHasIO;
+
+  return loopHasIO;
+}
+
+unsigned ApplyIOAttribute::getIOCategories(const llvm::BasicBlock &BB,
+                                           IOTrigger &Trigger) const {
+  unsigned categories = IOC_NONE;
+
+  for (const auto &inst : BB) {
+    const llvm::Function *calledFunc = nullptr;
+
+    const auto ioClass = getCallSiteIOClass(inst, calledFunc);
+    if (ioClass.Kind == IOKind::NONE)
+      continue;
+
+    if (!Trigger.Callee) {
+      Trigger.Site = &inst;
+      Trigger.Callee = calledFunc;
+      Trigger.Kind = ioClass.Kind;
+    }
+
+    categories |= ioClass.Categories;
+  }
+
+  return categories;
+}
+
+unsigned ApplyIOAttribute::getIOCategories(const llvm::Function &Func,
+                                           IOTrigger &Trigger) const {
+  unsigned categories = IOC_NONE;
+
+  for (const auto &bb : Func)
+    categories |= getIOCategories(bb, Trigger);
+
+  return categories;
+}
+
+unsigned ApplyIOAttribute::getIOCategories(const llvm::Function &Func) const {
+  IOTrigger trigger;
+
+  return getIOCategories(Func, trigger);
+}
+
+unsigned ApplyIOAttribute::getIOCategories(
+    llvm::ArrayRef<const llvm::Instruction *> Sites, IOTrigger &Trigger) const {
+  unsigned categories = IOC_NONE;
+
+  for (const auto *site : Sites) {
+    const llvm::Function *calledFunc = nullptr;
+
+    const auto ioClass = getCallSiteIOClass(*site, calledFunc);
+    if (ioClass.Kind == IOKind::NONE)
+      continue;
+
+    if (!Trigger.Callee) {
+      Trigger.Site = site;
+      Trigger.Callee = calledFunc;
+      Trigger.Kind = ioClass.Kind;
+    }
+
+    categories |= ioClass.Categories;
+  }
+
+  return categories;
+}
+
+bool ApplyIOAttribute::collectIOSites(const llvm::Module &M,
+                                      FunctionIOSiteMap &IOSites) const {
+  std::vector<const llvm::Function *> ioDecls;
+
+  // the declarations are visited in module order, so that the sites of each
+  // function are found in a deterministic order
+  for (const auto &func : M) {
+    const auto found = m_IODecls.find(&func);
+    if (found == m_IODecls.end() || found->second.Kind == IOKind::NONE)
+      continue;
+
+    if (func.hasAddressTaken())
+      return false;
+
+    ioDecls.push_back(&func);
+  }
+
+  // all the users of a declaration without its address taken are calls to it
+  for (const auto *decl : ioDecls)
+    for (const auto *user : decl->users()) {
+      NumIODeclUsersVisited++;
+
+      const auto *call = llvm::cast<llvm::CallBase>(user);
+      IOSites[call->getFunction()].push_back(call);
+    }
+
+  return true;
+}
+
+void ApplyIOAttribute::hasIO(const llvm::LoopInfo &LI,
+                             llvm::ArrayRef<const llvm::Instruction *> Sites,
+                             LoopIOMap &LoopSummaries) const {
+  for (const auto *L : LI.getLoopsInPreorder())
+    LoopSummaries[L] = false;
+
+  for (const auto *site : Sites) {
+    const llvm::Function *calledFunc = nullptr;
+
+    if (getCallSiteIOClass(*site, calledFunc).Kind == IOKind::NONE)
+      continue;
+
+    // the parents are already marked when the innermost loop is
+    for (const auto *L = LI.getLoopFor(site->getParent());
+         L && !LoopSummaries[L]; L = L->getParentLoop())
+      LoopSummaries[L] = true;
+  }
+
+  return;
+}
+
+void ApplyIOAttribute::propagate(const llvm::CallGraph &CG,
+                                 FunctionIOMap &IOSummaries,
+                                 const FunctionIOMap *LocalSummaries) const {
+  std::vector<const llvm::CallGraphNode *> nodes;
+  std::vector<std::pair<const llvm::Function *, const llvm::Function *>>
+      indirectEdges;
+
+  // SCCs are visited in post-order, so the summaries of all callees outside
+  // the current SCC are already available; the members of an SCC can reach
+  // each other and thus share the same categories
+  for (auto scci = llvm::scc_begin(&CG); !scci.isAtEnd(); ++scci) {
+    const auto &scc = *scci;
+    unsigned sccCategories = IOC_NONE;
+
+    for (const auto *node : scc) {
+      const auto *func = node->getFunction();
+      if (!func || func->isDeclaration())
+        continue;
+
+      nodes.push_back(node);
+      sccCategories |= LocalSummaries ? LocalSummaries->lookup(func)
+                                      : getIOCategories(*func);
+
+      for (auto ri = node->begin(), re = node->end();
+           sccCategories != IOC_ALL && ri != re; ++ri) {
+        const auto *callee = ri->second->getFunction();
+        if (callee)
+          sccCategories |= IOSummaries.lookup(callee);
+      }
+
+      // declarations among the indirect callees are already accounted for
+      llvm::SmallVector<const llvm::Function *, 8> indirectCallees;
+      getIndirectCallees(*func, indirectCallees);
+
+      for (const auto *callee : indirectCallees)
+        if (!callee->isDeclaration())
+          indirectEdges.emplace_back(func, callee);
+    }
+
+    for (const auto *node : scc) {
+      const auto *func = node->getFunction();
+      if (func && !func->isDeclaration())
+        IOSummaries[func] = sccCategories;
+    }
+  }
+
+  if (indirectEdges.empty())
+    return;
+
+  // the indirect edges are not part of the call graph and may close cycles
+  // that the SCC order misses; since the categories only grow, propagating
+  // them along the reversed edges until nothing changes terminates
+  llvm::DenseMap<const llvm::Function *,
+                 llvm::SmallVector<const llvm::Function *, 4>>
+      callers;
+
+  for (const auto *node : nodes)
+    for (const auto &record : *node) {
+      const auto *callee = record.second->getFunction();
+      if (callee && !callee->isDeclaration())
+        callers[callee].push_back(node->getFunction());
+    }
+
+  for (const auto &edge : indirectEdges)
+    callers[edge.second].push_back(edge.first);
+
+  std::vector<const llvm::Function *> workList;
+  for (const auto *node : nodes)
+    if (IOSummaries.lookup(node->getFunction()))
+      workList.push_back(node->getFunction());
+
+  while (!workList.empty()) {
+    const auto *callee = workList.back();
+    workList.pop_back();
+
+    const auto found = callers.find(callee);
+    if (found == callers.end())
+      continue;
+
+    const auto categories = IOSummaries.lookup(callee);
+
+    for (const auto *caller : found->second) {
+      auto &callerCategories = IOSummaries[caller];
+
+      if ((callerCategories | categories) != callerCategories) {
+        callerCategories |= categories;
+        workList.push_back(caller);
+      }
+    }
+  }
+
+  return;
+}
+
+void ApplyIOAttribute::proveNoIO(const llvm::CallGraph &CG,
+                                 FunctionNoIOMap &NoIOFuncs) const {
+  for (auto scci = llvm::scc_begin(&CG); !scci.isAtEnd(); ++scci) {
+    llvm::SmallPtrSet<const llvm::Function *, 8> scc;
+
+    for (const auto *node : *scci) {
+      const auto *func = node->getFunction();
+      if (func && !func->isDeclaration())
+        scc.insert(func);
+    }
+
+    // like the attributes that LLVM derives from a body, the proof holds
+    // only for the definition that the linker is bound to keep; the members
+    // of a component rely on each other, so one such member fails them all
+    bool noIO = !scc.empty() &&
+                std::all_of(scc.begin(), scc.end(), [](const llvm::Function *F) {
+                  return F->hasExactDefinition();
+                });
+    bool noSync = true;
+
+    for (auto fi = scc.begin(), fe = scc.end(); noIO && fi != fe; ++fi) {
+      const auto &func = **fi;
+
+      if (func.hasFnAttribute(m_IOAttr)) {
+        noIO = false;
+
+        break;
+      }
+
+      for (const auto &bb : func) {
+        for (const auto &inst : bb) {
+          if (maySync(inst))
+            noSync = false;
+
+          const auto *call = llvm::dyn_cast<llvm::CallBase>(&inst);
+          if (!call)
+            continue;
+
+          // indirect calls may reach functions of other modules
+          const auto *callee = llvm::dyn_cast<llvm::Function>(
+              call->getCalledOperand()->stripPointerCasts());
+
+          if (!callee || call->isInlineAsm()) {
+            noIO = false;
+
+            break;
+          }
+
+          if (callee->isIntrinsic()) {
+            noSync &= call->hasFnAttr(llvm::Attribute::NoSync);
+
+            continue;
+          }
+
+          if (!isNoIOCallee(*call, *callee, scc, NoIOFuncs, noSync)) {
+            noIO = false;
+
+            break;
+          }
+        }
+
+        if (!noIO)
+          break;
+      }
+    }
+
+    if (!noIO)
+      continue;
+
+    for (const auto *func : scc)
+      NoIOFuncs[func] = noSync;
+  }
+
+  return;
+}
+
+bool ApplyIOAttribute::applyNoIO(llvm::Function &func, bool NoSync) const {
+  func.addFnAttr(this->getNoIOAttr());
+
+  if (NoSync)
+    func.addFnAttr(llvm::Attribute::NoSync);
 
   return true;
 }
 
+bool ApplyIOAttribute::applyIOUnknown(llvm::Function &func) const {
+  func.addFnAttr(getIOUnknownAttr());
+
+  return apply(func, IOC_ALL);
+}
+
+bool ApplyIOAttribute::apply(llvm::Function &func,
+                             unsigned Categories) const {
+  func.addFnAttr(this->getIOAttr(), llvm::utostr(Categories));
+
+  return true;
+}
+
+bool ApplyIOAttribute::apply(llvm::Loop &L, bool HasIO) const {
+  auto &ctx = L.getHeader()->getContext();
+  const auto tag = HasIO ? LoopIOTag : LoopNoIOTag;
+
+  return setLoopTag(L, llvm::MDNode::get(ctx, llvm::MDString::get(ctx, tag)),
+                    {LoopIOTag, LoopNoIOTag});
+}
+
+bool ApplyIOAttribute::applyIOFrequency(llvm::Function &func,
+                                        double Frequency,
+                                        const uint64_t *Count) const {
+  std::string value;
+  llvm::raw_string_ostream os(value);
+  os << llvm::format("%.2f", Frequency);
+
+  func.addFnAttr(getIOFrequencyAttr(), os.str());
+
+  if (Count)
+    func.addFnAttr(getIOCountAttr(), llvm::utostr(*Count));
+
+  return true;
+}
+
+bool ApplyIOAttribute::applyIOFrequency(llvm::Loop &L,
+                                        double Frequency) const {
+  auto &ctx = L.getHeader()->getContext();
+
+  llvm::Metadata *mds[] = {
+      llvm::MDString::get(ctx, LoopIOFrequencyTag),
+      llvm::ConstantAsMetadata::get(
+          llvm::ConstantFP::get(llvm::Type::getDoubleTy(ctx), Frequency))};
+
+  return setLoopTag(L, llvm::MDNode::get(ctx, mds), {LoopIOFrequencyTag});
+}
+
+void ApplyIOAttribute::getIOSites(
+    const llvm::Function &Func,
+    llvm::SmallVectorImpl<const llvm::Instruction *> &Sites) const {
+  for (const auto &bb : Func)
+    for (const auto &inst : bb) {
+      const llvm::Function *calledFunc = nullptr;
+
+      if (getCallSiteIOClass(inst, calledFunc).Kind != IOKind::NONE)
+        Sites.push_back(&inst);
+    }
+
+  return;
+}
+
+void ApplyIOAttribute::getIndirectCallees(
+    const llvm::Function &Func,
+    llvm::SmallVectorImpl<const llvm::Function *> &Callees) const {
+  for (const auto &bb : Func)
+    for (const auto &inst : bb)
+      if (const auto *callees = getIndirectCallees(inst))
+        Callees.append(callees->begin(), callees->end());
+
+  return;
+}
+
 //
 // private methods
 //
 
-bool ApplyIOAttribute::hasCIO(const llvm::Function &Func) const {
-  if (!Func.hasName())
-    return false;
+ApplyIOAttribute::IOClass
+ApplyIOAttribute::getIOClass(const llvm::Function &Func) const {
+  const auto found = m_IODecls.find(&Func);
 
-  const auto &funcName = Func.getName();
-  llvm::LibFunc::Func TLIFunc;
+  if (found != m_IODecls.end()) {
+    m_NumClassificationHits++;
 
-  if (m_TLI.getLibFunc(funcName, TLIFunc) && m_TLI.has(TLIFunc) &&
-      m_IOLibFuncs.end() != m_IOLibFuncs.find(TLIFunc)) {
-    return true;
+    return found->second;
   }
 
-  return false;
+  m_NumClassificationMisses++;
+
+  return classifyDeclaration(Func);
 }
 
-llvm::Type *
-ApplyIOAttribute::getClassFromMethod(const llvm::FunctionType &FuncType) const {
-  const auto *potentialClassTypePtr = FuncType.getParamType(0);
-  if (!potentialClassTypePtr->isPointerTy())
-    return nullptr;
+ApplyIOAttribute::IOClass
+ApplyIOAttribute::classifyDeclaration(const llvm::Function &Func) const {
+  IOClass ioClass;
 
-  const auto *classType =
-      llvm::dyn_cast<llvm::PointerType>(potentialClassTypePtr)
-          ->getElementType();
+  ioClass.Categories = getCIOCategories(Func);
+  if (ioClass.Categories) {
+    ioClass.Kind = IOKind::LIBC;
 
-  if (!classType->isStructTy())
-    return nullptr;
+    return ioClass;
+  }
+
+  ioClass.Categories = getCxxIOCategories(Func);
+  if (ioClass.Categories) {
+    ioClass.Kind = IOKind::CXX_STREAM;
+
+    return ioClass;
+  }
+
+  // declarations may carry the attribute as a fact imported from other
+  // modules
+  ioClass.Categories = getAppliedIOCategories(Func);
+  if (ioClass.Categories)
+    ioClass.Kind = IOKind::IMPORTED;
 
-  return rm_const_ptr_t<decltype(classType)>(classType);
+  return ioClass;
 }
 
-std::string ApplyIOAttribute::demangleCxxName(const char *name) const {
-  std::string demangledName{""};
-  auto status = 0;
+unsigned ApplyIOAttribute::getCIOCategories(const llvm::Function &Func) const {
+  if (!Func.hasName())
+    return IOC_NONE;
+
+  const auto &funcName = Func.getName();
+  llvm::LibFunc TLIFunc;
 
-  const auto &demangledNamePtr =
-      malloc_unique_ptr<char>(abi::__cxa_demangle(name, 0, 0, &status));
+  NumTLILookups++;
 
-  if (!status)
-    demangledName = demangledNamePtr.get();
+  if (m_TLI.getLibFunc(funcName, TLIFunc)) {
+    if (!m_TLI.has(TLIFunc))
+      return IOC_NONE;
 
-  return demangledName;
+    const auto categories = getLibFuncIOCategories(TLIFunc);
+    if (categories)
+      return categories;
+  }
+
+  // names that newer target library infos recognize are also listed here
+  return getNamedIOCategories(funcName);
 }
 
-bool ApplyIOAttribute::hasCxxIO(const llvm::Function &Func) const {
+unsigned
+ApplyIOAttribute::getCxxIOCategories(const llvm::Function &Func) const {
   if (Func.getFunctionType()->getNumParams() < 1 || !Func.hasName())
-    return false;
+    return IOC_NONE;
 
-  const auto &funcName = demangleCxxName(Func.getName().data());
-  const auto &found1 =
-      std::find_if(std::begin(m_CxxIOFuncs), std::end(m_CxxIOFuncs),
-                   [&funcName](const auto &e) {
-                     return std::string::npos != funcName.find(e);
-                   });
+  NumCxxNameMatches++;
 
-  if (found1 == std::end(m_CxxIOFuncs))
-    return false;
+  return getCxxStreamIOCategories(Func.getName());
+}
 
-  const auto *classType = getClassFromMethod(*Func.getFunctionType());
-  if (!classType)
-    return false;
+unsigned
+ApplyIOAttribute::getAppliedIOCategories(const llvm::Function &Func) const {
+  if (!Func.hasFnAttribute(m_IOAttr))
+    return IOC_NONE;
 
-  const auto &classTypeName = classType->getStructName();
-  const auto &found2 =
-      std::find_if(std::begin(m_CxxIOTypes), std::end(m_CxxIOTypes),
-                   [&classTypeName](const auto &e) {
-                     return llvm::StringRef::npos != classTypeName.find(e);
-                   });
+  unsigned categories;
+  const auto value = Func.getFnAttribute(m_IOAttr).getValueAsString();
 
-  if (found2 == std::end(m_CxxIOTypes))
-    return false;
+  if (value.getAsInteger(10, categories) || !categories)
+    return IOC_ALL;
 
-  return true;
+  return categories & IOC_ALL;
 }
 
-llvm::Function *
-ApplyIOAttribute::getCalledFunction(const llvm::Instruction &Inst) const {
-  if (llvm::isa<llvm::IntrinsicInst>(Inst))
-    return nullptr;
+ApplyIOAttribute::IOClass
+ApplyIOAttribute::getCallSiteIOClass(const llvm::Instruction &Inst,
+                                     const llvm::Function *&Callee) const {
+  IOClass ioClass;
 
-  const auto *callInst = llvm::dyn_cast<llvm::CallInst>(&Inst);
-  if (!callInst)
-    return nullptr;
+  const auto *call = llvm::dyn_cast<llvm::CallBase>(&Inst);
+  if (!call || llvm::isa<llvm::IntrinsicInst>(Inst) || call->isInlineAsm())
+    return ioClass;
 
-  const auto *calledFunc = callInst->getCalledFunction();
-  if (!calledFunc)
-    return nullptr;
+  NumCallSitesInspected++;
 
-  if (!callInst->getCalledFunction()->isDeclaration())
-    return nullptr;
+  const auto *calledFunc = llvm::dyn_cast<llvm::Function>(
+      call->getCalledOperand()->stripPointerCasts());
 
-  return const_cast<llvm::Function *>(calledFunc);
-}
-
-void ApplyIOAttribute::setupLibCIOFuncs() {
-  // TODO what about calls that might have other side-effects
-  // system()
-  // getenv()
-  // setenv()
-  // unsetenv()
-  m_IOLibFuncs.insert(llvm::LibFunc::under_IO_getc);
-  m_IOLibFuncs.insert(llvm::LibFunc::under_IO_putc);
-  m_IOLibFuncs.insert(llvm::LibFunc::dunder_isoc99_scanf);
-  m_IOLibFuncs.insert(llvm::LibFunc::access);
-  m_IOLibFuncs.insert(llvm::LibFunc::chmod);
-  m_IOLibFuncs.insert(llvm::LibFunc::chown);
-  m_IOLibFuncs.insert(llvm::LibFunc::closedir);
-  m_IOLibFuncs.insert(llvm::LibFunc::fclose);
-  m_IOLibFuncs.insert(llvm::LibFunc::fdopen);
-  m_IOLibFuncs.insert(llvm::LibFunc::feof);
-  m_IOLibFuncs.insert(llvm::LibFunc::ferror);
-  m_IOLibFuncs.insert(llvm::LibFunc::fflush);
-  m_IOLibFuncs.insert(llvm::LibFunc::fgetc);
-  m_IOLibFuncs.insert(llvm::LibFunc::fgetpos);
-  m_IOLibFuncs.insert(llvm::LibFunc::fgets);
-  m_IOLibFuncs.insert(llvm::LibFunc::fileno);
-  m_IOLibFuncs.insert(llvm::LibFunc::fiprintf);
-  m_IOLibFuncs.insert(llvm::LibFunc::flockfile);
-  m_IOLibFuncs.insert(llvm::LibFunc::fopen);
-  m_IOLibFuncs.insert(llvm::LibFunc::fopen64);
-  m_IOLibFuncs.insert(llvm::LibFunc::fprintf);
-  m_IOLibFuncs.insert(llvm::LibFunc::fputc);
-  m_IOLibFuncs.insert(llvm::LibFunc::fputs);
-  m_IOLibFuncs.insert(llvm::LibFunc::fread);
-  m_IOLibFuncs.insert(llvm::LibFunc::fscanf);
-  m_IOLibFuncs.insert(llvm::LibFunc::fseek);
-  m_IOLibFuncs.insert(llvm::LibFunc::fseeko);
-  m_IOLibFuncs.insert(llvm::LibFunc::fseeko64);
-  m_IOLibFuncs.insert(llvm::LibFunc::fsetpos);
-  m_IOLibFuncs.insert(llvm::LibFunc::fstatvfs);
-  m_IOLibFuncs.insert(llvm::LibFunc::fstatvfs64);
-  m_IOLibFuncs.insert(llvm::LibFunc::ftell);
-  m_IOLibFuncs.insert(llvm::LibFunc::ftello);
-  m_IOLibFuncs.insert(llvm::LibFunc::ftello64);
-  m_IOLibFuncs.insert(llvm::LibFunc::ftrylockfile);
-  m_IOLibFuncs.insert(llvm::LibFunc::funlockfile);
-  m_IOLibFuncs.insert(llvm::LibFunc::fwrite);
-  m_IOLibFuncs.insert(llvm::LibFunc::getc);
-  m_IOLibFuncs.insert(llvm::LibFunc::getc_unlocked);
-  m_IOLibFuncs.insert(llvm::LibFunc::getchar);
-  m_IOLibFuncs.insert(llvm::LibFunc::getlogin_r);
-  m_IOLibFuncs.insert(llvm::LibFunc::getpwnam);
-  m_IOLibFuncs.insert(llvm::LibFunc::gets);
-  m_IOLibFuncs.insert(llvm::LibFunc::iprintf);
-  m_IOLibFuncs.insert(llvm::LibFunc::lchown);
-  m_IOLibFuncs.insert(llvm::LibFunc::lstat);
-  m_IOLibFuncs.insert(llvm::LibFunc::lstat64);
-  m_IOLibFuncs.insert(llvm::LibFunc::mkdir);
-  m_IOLibFuncs.insert(llvm::LibFunc::open);
-  m_IOLibFuncs.insert(llvm::LibFunc::open64);
-  m_IOLibFuncs.insert(llvm::LibFunc::opendir);
-  m_IOLibFuncs.insert(llvm::LibFunc::pclose);
-  m_IOLibFuncs.insert(llvm::LibFunc::perror);
-  m_IOLibFuncs.insert(llvm::LibFunc::popen);
-  m_IOLibFuncs.insert(llvm::LibFunc::pread);
-  m_IOLibFuncs.insert(llvm::LibFunc::printf);
-  m_IOLibFuncs.insert(llvm::LibFunc::putc);
-  m_IOLibFuncs.insert(llvm::LibFunc::putchar);
-  m_IOLibFuncs.insert(llvm::LibFunc::puts);
-  m_IOLibFuncs.insert(llvm::LibFunc::pwrite);
-  m_IOLibFuncs.insert(llvm::LibFunc::read);
-  m_IOLibFuncs.insert(llvm::LibFunc::readlink);
-  m_IOLibFuncs.insert(llvm::LibFunc::realpath);
-  m_IOLibFuncs.insert(llvm::LibFunc::remove);
-  m_IOLibFuncs.insert(llvm::LibFunc::rename);
-  m_IOLibFuncs.insert(llvm::LibFunc::rewind);
-  m_IOLibFuncs.insert(llvm::LibFunc::rmdir);
-  m_IOLibFuncs.insert(llvm::LibFunc::scanf);
-  m_IOLibFuncs.insert(llvm::LibFunc::siprintf);
-  m_IOLibFuncs.insert(llvm::LibFunc::stat);
-  m_IOLibFuncs.insert(llvm::LibFunc::stat64);
-  m_IOLibFuncs.insert(llvm::LibFunc::statvfs);
-  m_IOLibFuncs.insert(llvm::LibFunc::statvfs64);
-  m_IOLibFuncs.insert(llvm::LibFunc::tmpfile);
-  m_IOLibFuncs.insert(llvm::LibFunc::tmpfile64);
-  m_IOLibFuncs.insert(llvm::LibFunc::ungetc);
-  m_IOLibFuncs.insert(llvm::LibFunc::unlink);
-  m_IOLibFuncs.insert(llvm::LibFunc::vfprintf);
-  m_IOLibFuncs.insert(llvm::LibFunc::vfscanf);
-  m_IOLibFuncs.insert(llvm::LibFunc::vprintf);
-  m_IOLibFuncs.insert(llvm::LibFunc::vscanf);
-  m_IOLibFuncs.insert(llvm::LibFunc::vsnprintf);
-  m_IOLibFuncs.insert(llvm::LibFunc::vsscanf);
-  m_IOLibFuncs.insert(llvm::LibFunc::write);
+  if (calledFunc) {
+    if (calledFunc->isDeclaration() && !calledFunc->isIntrinsic()) {
+      ioClass = getIOClass(*calledFunc);
+      Callee = calledFunc;
+    }
 
-  return;
+    return ioClass;
+  }
+
+  const auto *callees = getIndirectCallees(Inst);
+  if (!callees)
+    return ioClass;
+
+  NumIndirectCallSitesResolved++;
+
+  // the bodies of defined callees are left to the interprocedural mode,
+  // just like for direct calls
+  for (const auto *callee : *callees) {
+    if (!callee->isDeclaration())
+      continue;
+
+    const auto calleeClass = getIOClass(*callee);
+    if (calleeClass.Kind == IOKind::NONE)
+      continue;
+
+    if (ioClass.Kind == IOKind::NONE) {
+      ioClass.Kind = calleeClass.Kind;
+      Callee = callee;
+    }
+
+    ioClass.Categories |= calleeClass.Categories;
+  }
+
+  return ioClass;
 }
 
-void ApplyIOAttribute::setupCxxIOFuncs() {
-  m_CxxIOFuncs.push_back("put");
-  m_CxxIOFuncs.push_back("write");
-  m_CxxIOFuncs.push_back("flush");
-  m_CxxIOFuncs.push_back("get");
-  m_CxxIOFuncs.push_back("peek");
-  m_CxxIOFuncs.push_back("unget");
-  m_CxxIOFuncs.push_back("putback");
-  m_CxxIOFuncs.push_back("getline");
-  m_CxxIOFuncs.push_back("ignore");
-  m_CxxIOFuncs.push_back("readsome");
-  m_CxxIOFuncs.push_back("sync");
-  m_CxxIOFuncs.push_back("open");
-  m_CxxIOFuncs.push_back("close");
-  m_CxxIOFuncs.push_back("operator<<");
-  m_CxxIOFuncs.push_back("operator>>");
-
-  // ctors
-  m_CxxIOFuncs.push_back("basic_ostream");
-  m_CxxIOFuncs.push_back("basic_istream");
-  m_CxxIOFuncs.push_back("basic_iostream");
-  m_CxxIOFuncs.push_back("basic_ofstream");
-  m_CxxIOFuncs.push_back("basic_istream");
-  m_CxxIOFuncs.push_back("basic_fstream");
-
-  m_CxxIOTypes.push_back("basic_ostream");
-  m_CxxIOTypes.push_back("basic_istream");
-  m_CxxIOTypes.push_back("basic_iostream");
-  m_CxxIOTypes.push_back("basic_ofstream");
-  m_CxxIOTypes.push_back("basic_istream");
-  m_CxxIOTypes.push_back("basic_fstream");
+bool ApplyIOAttribute::isNoIOCallee(
+    const llvm::CallBase &Call, const llvm::Function &Callee,
+    const llvm::SmallPtrSetImpl<const llvm::Function *> &SCC,
+    const FunctionNoIOMap &NoIOFuncs, bool &NoSync) const {
+  if (Callee.isDeclaration()) {
+    if (getIOClass(Callee).Kind != IOKind::NONE)
+      return false;
+
+    NoSync &= Callee.hasFnAttribute(llvm::Attribute::NoSync);
+
+    // declarations may carry the fact imported from other modules, which was
+    // proven without indirect calls, so the callee calls back no function
+    if (Callee.hasFnAttribute(m_NoIOAttr))
+      return true;
+
+    if (mayCallBack(Call))
+      return false;
+
+    llvm::LibFunc TLIFunc;
+
+    return Callee.hasName() && m_TLI.getLibFunc(Callee.getName(), TLIFunc) &&
+           m_TLI.has(TLIFunc);
+  }
+
+  // the definition of an interposable function may be replaced at link time
+  if (Callee.isInterposable())
+    return false;
+
+  if (SCC.count(&Callee))
+    return true;
+
+  const auto found = NoIOFuncs.find(&Callee);
+  if (found == NoIOFuncs.end())
+    return false;
+
+  NoSync &= found->second;
+
+  return true;
+}
+
+const llvm::SmallVectorImpl<const llvm::Function *> *
+ApplyIOAttribute::getIndirectCallees(const llvm::Instruction &Inst) const {
+  const auto *call = llvm::dyn_cast<llvm::CallBase>(&Inst);
+  if (!call || !call->isIndirectCall())
+    return nullptr;
+
+  const auto found = m_IndirectCalleeIndex->find(call->getFunctionType());
+
+  return found != m_IndirectCalleeIndex->end() ? &found->second : nullptr;
 }
 
 } // namespace icsa end
@@ -0,0 +1,191 @@
+//
+//
+//
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/Analysis/TargetLibraryInfo.h"
+// using llvm::TargetLibraryAnalysis
+
+#include "llvm/Passes/PassBuilder.h"
+// using llvm::PassBuilder
+
+#include "llvm/Passes/PassPlugin.h"
+// using llvm::PassPluginLibraryInfo
+
+#include "llvm/ADT/StringExtras.h"
+// using llvm::utostr
+
+#include "Config.hpp"
+
+#include "ApplyIOAttribute.hpp"
+
+#include "ApplyIOAttributeAnalysis.hpp"
+
+#define STRINGIFY_UTIL(x) #x
+#define STRINGIFY(x) STRINGIFY_UTIL(x)
+
+namespace icsa {
+
+namespace {
+
+bool IsSameIndex(const IndirectCalleeMap &LHS, const IndirectCalleeMap &RHS) {
+  if (LHS.size() != RHS.size())
+    return false;
+
+  for (const auto &e : LHS) {
+    const auto found = RHS.find(e.first);
+
+    if (found == RHS.end() || found->second != e.second)
+      return false;
+  }
+
+  return true;
+}
+
+} // namespace anonymous end
+
+llvm::AnalysisKey IndirectCalleeAnalysis::Key;
+llvm::AnalysisKey ApplyIOAttributeAnalysis::Key;
+
+IndirectCalleeAnalysis::Result
+IndirectCalleeAnalysis::run(llvm::Module &M, llvm::ModuleAnalysisManager &MAM) {
+  Result result;
+  ApplyIOAttribute::indexIndirectCallees(M, result.m_Callees);
+
+  return result;
+}
+
+bool IndirectCalleeAnalysis::Result::invalidate(
+    llvm::Module &M, const llvm::PreservedAnalyses &PA,
+    llvm::ModuleAnalysisManager::Invalidator &Inv) {
+  // function analyses may only use module analyses that are never
+  // invalidated implicitly, so the index is dropped only when abandoned
+  auto PAC = PA.getChecker<IndirectCalleeAnalysis>();
+
+  return !PAC.preservedWhenStateless();
+}
+
+bool ApplyIOAttributeAnalysis::Result::invalidate(
+    llvm::Function &F, const llvm::PreservedAnalyses &PA,
+    llvm::FunctionAnalysisManager::Invalidator &Inv) {
+  // any change to the instructions might add or remove a call, so the
+  // verdict survives only when it is explicitly preserved
+  auto PAC = PA.getChecker<ApplyIOAttributeAnalysis>();
+
+  return !(PAC.preserved() ||
+           PAC.preservedSet<llvm::AllAnalysesOn<llvm::Function>>());
+}
+
+ApplyIOAttributeAnalysis::Result
+ApplyIOAttributeAnalysis::run(llvm::Function &F,
+                              llvm::FunctionAnalysisManager &FAM) {
+  const auto &TLI = FAM.getResult<llvm::TargetLibraryAnalysis>(F);
+  ApplyIOAttribute aioattr(TLI);
+
+  // a function analysis may only use module analyses that are already
+  // computed; the verdict then depends on the index, so it is invalidated
+  // along with it
+  auto &MAMProxy = FAM.getResult<llvm::ModuleAnalysisManagerFunctionProxy>(F);
+  const auto *callees =
+      MAMProxy.getCachedResult<IndirectCalleeAnalysis>(*F.getParent());
+
+  if (callees) {
+    MAMProxy.registerOuterAnalysisInvalidation<IndirectCalleeAnalysis,
+                                               ApplyIOAttributeAnalysis>();
+    aioattr.classify(F, callees->getCallees());
+  } else
+    aioattr.classify(*F.getParent());
+
+  return Result(aioattr.getIOCategories(F));
+}
+
+llvm::PreservedAnalyses
+ApplyIOAttributeTransform::run(llvm::Module &M,
+                               llvm::ModuleAnalysisManager &MAM) {
+  auto &FAM =
+      MAM.getResult<llvm::FunctionAnalysisManagerModuleProxy>(M).getManager();
+  bool hasChanged = false;
+
+  // the index survives the changes of other passes, so a stale one is
+  // abandoned along with the verdicts computed over it; the check is linear
+  // in the module, like the index itself
+  if (const auto *cached = MAM.getCachedResult<IndirectCalleeAnalysis>(M)) {
+    IndirectCalleeMap callees;
+    ApplyIOAttribute::indexIndirectCallees(M, callees);
+
+    if (!IsSameIndex(callees, cached->getCallees())) {
+      auto PA = llvm::PreservedAnalyses::all();
+      PA.abandon<IndirectCalleeAnalysis>();
+      MAM.invalidate(M, PA);
+    }
+  }
+
+  // computed up front, so that the function analyses find it cached
+  MAM.getResult<IndirectCalleeAnalysis>(M);
+
+  for (auto &func : M) {
+    if (func.isDeclaration() || func.hasFnAttribute(m_IOAttr))
+      continue;
+
+    const auto &result = FAM.getResult<ApplyIOAttributeAnalysis>(func);
+
+    if (result.hasIO()) {
+      func.addFnAttr(m_IOAttr, llvm::utostr(result.getIOCategories()));
+      hasChanged = true;
+    }
+  }
+
+  if (!hasChanged)
+    return llvm::PreservedAnalyses::all();
+
+  // only a string attribute was added, so no function analysis is affected
+  llvm::PreservedAnalyses PA;
+  PA.preserveSet<llvm::AllAnalysesOn<llvm::Function>>();
+  PA.preserve<llvm::FunctionAnalysisManagerModuleProxy>();
+
+  return PA;
+}
+
+} // namespace icsa end
+
+// plugin registration for the new pass manager
+
+extern "C" LLVM_ATTRIBUTE_WEAK llvm::PassPluginLibraryInfo
+llvmGetPassPluginInfo() {
+  return {
+      LLVM_PLUGIN_API_VERSION, "ApplyIOAttribute",
+      STRINGIFY(APPLYIOATTRIBUTE_VERSION), [](llvm::PassBuilder &PB) {
+        PB.registerAnalysisRegistrationCallback(
+            [](llvm::ModuleAnalysisManager &MAM) {
+              MAM.registerPass([] { return icsa::IndirectCalleeAnalysis(); });
+            });
+
+        PB.registerAnalysisRegistrationCallback(
+            [](llvm::FunctionAnalysisManager &FAM) {
+              FAM.registerPass([] { return icsa::ApplyIOAttributeAnalysis(); });
+            });
+
+        PB.registerPipelineParsingCallback(
+            [](llvm::StringRef Name, llvm::ModulePassManager &MPM,
+               llvm::ArrayRef<llvm::PassBuilder::PipelineElement>) {
+              if (Name != "apply-io-attribute")
+                return false;
+
+              MPM.addPass(icsa::ApplyIOAttributeTransform());
+
+              return true;
+            });
+
+        // equivalent of EP_EarlyAsPossible for clang; the type of the
+        // optimization level parameter differs across LLVM versions
+        PB.registerPipelineStartEPCallback(
+            [](llvm::ModulePassManager &MPM, auto) {
+              MPM.addPass(icsa::ApplyIOAttributeTransform());
+            });
+      }};
+}
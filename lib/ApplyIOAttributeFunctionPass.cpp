@@ -0,0 +1,89 @@
+//
+//
+//
+
+#include "llvm/Pass.h"
+// using llvm::RegisterPass
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/Analysis/TargetLibraryInfo.h"
+// using llvm::TargetLibraryInfoWrapperPass
+
+#include "llvm/ADT/Statistic.h"
+// using STATISTIC macro
+
+#include "Config.hpp"
+
+#include "ApplyIOAttributeFunctionPass.hpp"
+
+// some of the above headers undefine it
+#define DEBUG_TYPE "applyioattributefunction"
+
+// plugin registration for opt
+
+#define STRINGIFY_UTIL(x) #x
+#define STRINGIFY(x) STRINGIFY_UTIL(x)
+
+#define PRJ_CMDLINE_DESC(x)                                                    \
+  x " (version: " STRINGIFY(APPLYIOATTRIBUTE_VERSION) ")"
+
+char icsa::ApplyIOAttributeFunctionPass::ID = 0;
+static llvm::RegisterPass<icsa::ApplyIOAttributeFunctionPass>
+    X("apply-io-attribute-function",
+      PRJ_CMDLINE_DESC("apply IO attribute function pass"), false, false);
+
+STATISTIC(NumProcessed, "Number of functions processed");
+STATISTIC(NumApplied, "Number of IO attribute applications");
+
+namespace icsa {
+
+bool ApplyIOAttributeFunctionPass::doInitialization(llvm::Module &M) {
+  m_AIOAttr.reset();
+
+  return false;
+}
+
+bool ApplyIOAttributeFunctionPass::doFinalization(llvm::Module &M) {
+  m_AIOAttr.reset();
+
+  return false;
+}
+
+void ApplyIOAttributeFunctionPass::getAnalysisUsage(
+    llvm::AnalysisUsage &AU) const {
+  AU.addRequired<llvm::TargetLibraryInfoWrapperPass>();
+  AU.setPreservesAll();
+
+  return;
+}
+
+// the function passes in between may add declarations, which are then
+// classified on each lookup, but they cannot remove any
+bool ApplyIOAttributeFunctionPass::runOnFunction(llvm::Function &F) {
+  if (!m_AIOAttr) {
+    const auto &TLI =
+        getAnalysis<llvm::TargetLibraryInfoWrapperPass>().getTLI(F);
+    m_AIOAttr.reset(new ApplyIOAttribute(TLI));
+    m_AIOAttr->classify(*F.getParent());
+  }
+
+  NumProcessed++;
+
+  if (F.hasFnAttribute(m_AIOAttr->getIOAttr()))
+    return false;
+
+  const auto categories = m_AIOAttr->getIOCategories(F);
+  if (!categories)
+    return false;
+
+  NumApplied++;
+
+  return m_AIOAttr->apply(F, categories);
+}
+
+} // namespace icsa end
@@ -2,8 +2,6 @@
 //
 //
 
-#define DEBUG_TYPE "applyioattribute"
-
 #include "llvm/Pass.h"
 // using llvm::RegisterPass
 
@@ -19,9 +17,34 @@
 #include "llvm/IR/Function.h"
 // using llvm::Function
 
+#include "llvm/IR/InstrTypes.h"
+// using llvm::CallBase
+
 #include "llvm/Support/Casting.h"
 // using llvm::dyn_cast
 
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/ADT/SmallPtrSet.h"
+// using llvm::SmallPtrSet
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/Analysis/CallGraph.h"
+// using llvm::CallGraphWrapperPass
+
+#include "llvm/Analysis/BlockFrequencyInfoImpl.h"
+// using llvm::BlockFrequencyInfoImpl
+
+#include "llvm/Analysis/BranchProbabilityInfo.h"
+// using llvm::BranchProbabilityInfo
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::LoopInfo
+// using llvm::LoopInfoWrapperPass
+
 #include "llvm/IR/LegacyPassManager.h"
 // using llvm::PassManagerBase
 
@@ -32,6 +55,9 @@
 #include "llvm/Support/raw_ostream.h"
 // using llvm::raw_fd_ostream
 
+#include "llvm/Support/Format.h"
+// using llvm::format
+
 #include "llvm/Support/CommandLine.h"
 // using llvm::cl::opt
 // using llvm::cl::desc
@@ -39,13 +65,42 @@
 #include "llvm/Support/FileSystem.h"
 // using llvm::sys::fs::OpenFlags
 
+#include "llvm/Support/ThreadPool.h"
+// using llvm::ThreadPool
+
+#include "llvm/Support/Threading.h"
+// using llvm::hardware_concurrency
+
 #include "llvm/Support/Debug.h"
 // using DEBUG macro
 // using llvm::dbgs
 
+#include "llvm/ADT/Statistic.h"
+// using STATISTIC macro
+
+#include "llvm/Support/Timer.h"
+// using llvm::NamedRegionTimer
+
+#include "llvm/Support/TimeProfiler.h"
+// using llvm::TimeTraceScope
+
 #include <set>
 // using std::set
 
+#include <vector>
+// using std::vector
+
+#include <algorithm>
+// using std::min
+// using std::count
+// using std::stable_sort
+
+#include <utility>
+// using std::move
+
+#include <chrono>
+// using std::chrono::steady_clock
+
 #include <string>
 // using std::string
 
@@ -58,12 +113,27 @@
 #include <cstring>
 // using std::strncmp
 
+#include <cmath>
+// using std::ldexp
+// using std::llround
+
 #include "Config.hpp"
 
 #include "BWList.hpp"
 
+#include "IOCache.hpp"
+
+#include "IOSummary.hpp"
+
+#include "IOInstrumentation.hpp"
+
 #include "ApplyIOAttributePass.hpp"
 
+#include "ApplyIOAttributeFunctionPass.hpp"
+
+// some of the above headers undefine it
+#define DEBUG_TYPE "applyioattribute"
+
 #ifndef NDEBUG
 #define PLUGIN_OUT llvm::outs()
 //#define PLUGIN_OUT llvm::nulls()
@@ -76,6 +146,9 @@
   } while (0);
 #else // NDEBUG
 #define PLUGIN_OUT llvm::dbgs()
+
+// the DEBUG macro of LLVM was renamed in LLVM 7
+#define DEBUG(X) LLVM_DEBUG(X)
 #endif // NDEBUG
 
 #define PLUGIN_ERR llvm::errs()
@@ -101,17 +174,62 @@ static llvm::RegisterPass<icsa::ApplyIOAttributePass>
 // add an instance of this pass and a static instance of the
 // RegisterStandardPasses class
 
+// the callbacks are registered at every supported extension point, since the
+// command line is not parsed yet, and only the selected one adds the pass
+
+static llvm::cl::opt<llvm::PassManagerBuilder::ExtensionPointTy> ExtensionPoint(
+    "aioattr-ep", llvm::cl::desc("clang pipeline position of the pass"),
+    llvm::cl::init(llvm::PassManagerBuilder::EP_EarlyAsPossible),
+    llvm::cl::values(
+        clEnumValN(llvm::PassManagerBuilder::EP_EarlyAsPossible, "early",
+                   "before any optimization"),
+        clEnumValN(llvm::PassManagerBuilder::EP_ScalarOptimizerLate,
+                   "scalar-optimizer-late",
+                   "after the scalar optimizations of the inliner pipeline"),
+        clEnumValN(llvm::PassManagerBuilder::EP_VectorizerStart,
+                   "vectorizer-start", "before the loop vectorizer"),
+        clEnumValN(llvm::PassManagerBuilder::EP_OptimizerLast,
+                   "optimizer-last", "after all optimizations")));
+
+static llvm::cl::opt<bool> FunctionPassForm(
+    "aioattr-function-pass",
+    llvm::cl::desc("add the function pass form to the clang pipeline, which "
+                   "applies the local IO attribute only (always used at the "
+                   "early extension point)"));
+
+template <llvm::PassManagerBuilder::ExtensionPointTy EP>
 static void
 registerApplyIOAttributePass(const llvm::PassManagerBuilder &Builder,
                              llvm::legacy::PassManagerBase &PM) {
-  PM.add(new icsa::ApplyIOAttributePass());
+  if (EP != ExtensionPoint)
+    return;
+
+  // the passes of the earliest extension point go to the function pass
+  // manager, which cannot run a module pass
+  if (FunctionPassForm || llvm::PassManagerBuilder::EP_EarlyAsPossible == EP)
+    PM.add(new icsa::ApplyIOAttributeFunctionPass());
+  else
+    PM.add(new icsa::ApplyIOAttributePass());
 
   return;
 }
 
-static llvm::RegisterStandardPasses
-    RegisterApplyIOAttributePass(llvm::PassManagerBuilder::EP_EarlyAsPossible,
-                                 registerApplyIOAttributePass);
+static llvm::RegisterStandardPasses RegisterApplyIOAttributePassEarly(
+    llvm::PassManagerBuilder::EP_EarlyAsPossible,
+    registerApplyIOAttributePass<llvm::PassManagerBuilder::EP_EarlyAsPossible>);
+
+static llvm::RegisterStandardPasses RegisterApplyIOAttributePassScalarLate(
+    llvm::PassManagerBuilder::EP_ScalarOptimizerLate,
+    registerApplyIOAttributePass<
+        llvm::PassManagerBuilder::EP_ScalarOptimizerLate>);
+
+static llvm::RegisterStandardPasses RegisterApplyIOAttributePassVectorizer(
+    llvm::PassManagerBuilder::EP_VectorizerStart,
+    registerApplyIOAttributePass<llvm::PassManagerBuilder::EP_VectorizerStart>);
+
+static llvm::RegisterStandardPasses RegisterApplyIOAttributePassLast(
+    llvm::PassManagerBuilder::EP_OptimizerLast,
+    registerApplyIOAttributePass<llvm::PassManagerBuilder::EP_OptimizerLast>);
 
 //
 
@@ -119,49 +237,493 @@ static llvm::cl::opt<std::string> ReportStatsFilename(
     "aioattr-stats",
     llvm::cl::desc("apply IO attribute stats report filename"));
 
+static llvm::cl::opt<std::string> AggregateStatsFilename(
+    "aioattr-stats-aggregate",
+    llvm::cl::desc("append one stats record per module to this file, which "
+                   "may be shared by concurrent compilations"));
+
+enum class ReportFormatKind : int { TEXT, JSON };
+
+static llvm::cl::opt<ReportFormatKind> ReportFormat(
+    "aioattr-report-format", llvm::cl::desc("stats report format"),
+    llvm::cl::init(ReportFormatKind::TEXT),
+    llvm::cl::values(clEnumValN(ReportFormatKind::TEXT, "text",
+                                "counters and altered function names"),
+                     clEnumValN(ReportFormatKind::JSON, "json",
+                                "one record per analyzed function")));
+
 static llvm::cl::opt<std::string>
     FuncWhileListFilename("aioattr-fn-whitelist",
                           llvm::cl::desc("function whitelist"));
 
+static llvm::cl::opt<std::string>
+    FuncBlackListFilename("aioattr-fn-blacklist",
+                          llvm::cl::desc("function blacklist"));
+
+static llvm::cl::opt<unsigned> NumThreads(
+    "aioattr-threads",
+    llvm::cl::desc("number of threads used for function analysis"),
+    llvm::cl::init(1));
+
+static llvm::cl::opt<std::string> CacheDirectory(
+    "aioattr-cache-dir",
+    llvm::cl::desc("directory of the persistent analysis cache of the ODR "
+                   "functions"));
+
+static llvm::cl::opt<std::string> ThinLTOSummaryFilename(
+    "aioattr-thinlto-summary",
+    llvm::cl::desc("write the module IO summary for the ThinLTO thin link"));
+
+static llvm::cl::opt<std::string> ThinLTOFactsFilename(
+    "aioattr-thinlto-facts",
+    llvm::cl::desc("read the IO facts resolved during the ThinLTO thin link"));
+
+static llvm::cl::opt<bool> InterproceduralMode(
+    "aioattr-ipo",
+    llvm::cl::desc("propagate IO attribute bottom-up over the call graph"));
+
+static llvm::cl::opt<bool> NoIOMode(
+    "aioattr-noio",
+    llvm::cl::desc("apply the no IO attribute and nosync to the functions "
+                   "proven IO-free over the call graph"));
+
+static llvm::cl::opt<bool> HotnessMode(
+    "aioattr-hotness",
+    llvm::cl::desc("estimate the dynamic IO frequency of functions and loops "
+                   "from block frequencies and profiles"));
+
+static llvm::cl::opt<bool> InstrumentMode(
+    "aioattr-instrument",
+    llvm::cl::desc("count and time the IO call sites at run time (requires "
+                   "linking with the aioattr-rt runtime)"));
+
+static llvm::cl::opt<unsigned> BudgetInstructions(
+    "aioattr-budget-insts",
+    llvm::cl::desc("largest function scanned, in instructions (0: no limit); "
+                   "larger ones are marked as with unknown IO"),
+    llvm::cl::init(0));
+
+static llvm::cl::opt<unsigned> BudgetMilliseconds(
+    "aioattr-budget-ms",
+    llvm::cl::desc("time allowed for matching the function lists and "
+                   "scanning the functions of a module, in milliseconds (0: "
+                   "no limit); the functions left are marked as with unknown "
+                   "IO"),
+    llvm::cl::init(0));
+
+enum class IOEngineKind : int { WALK, USELIST, VERIFY };
+
+static llvm::cl::opt<IOEngineKind> IOEngine(
+    "aioattr-engine", llvm::cl::desc("function analysis engine"),
+    llvm::cl::init(IOEngineKind::WALK),
+    llvm::cl::values(
+        clEnumValN(IOEngineKind::WALK, "walk",
+                   "scan every instruction of each function"),
+        clEnumValN(IOEngineKind::USELIST, "uselist",
+                   "visit only the users of the IO declarations"),
+        clEnumValN(IOEngineKind::VERIFY, "verify",
+                   "run both engines and report any difference")));
+
+STATISTIC(NumProcessed, "Number of functions processed");
+STATISTIC(NumApplied, "Number of IO attribute applications");
+STATISTIC(NumWhitelistRejections, "Number of functions rejected by whitelist");
+STATISTIC(NumBlacklistRejections, "Number of functions rejected by blacklist");
+STATISTIC(NumNoIOApplied, "Number of no IO attribute applications");
+STATISTIC(NumNoSyncApplied, "Number of nosync attribute applications");
+STATISTIC(NumUseListFallbacks,
+          "Number of modules scanned by walking instead of use lists");
+STATISTIC(NumSitesInstrumented, "Number of instrumented IO call sites");
+STATISTIC(NumOverBudget, "Number of functions not scanned due to the budget");
+
 namespace icsa {
 
 namespace {
 
-long NumFunctionsProcessed = 0;
-long NumAttributeApplications = 0;
-std::set<std::string> FunctionsAltered;
+const char *TimerGroupName = "aioattr";
+const char *TimerGroupDesc = "Apply IO attribute";
+
+// the report state of one module; the altered functions are streamed from
+// the verdicts instead of being copied
+struct ModuleStats {
+  long NumFunctionsProcessed = 0;
+  long NumAttributeApplications = 0;
+  llvm::ArrayRef<llvm::Function *> WorkList;
+  llvm::ArrayRef<unsigned> Verdicts;
+  llvm::ArrayRef<char> OverBudget;
+};
+
+// estimated dynamic IO of a function
+struct IOHotness {
+  const llvm::Function *Func = nullptr;
+  double Frequency = 0; // IO calls per invocation
+  bool HasCount = false;
+  uint64_t Count = 0; // IO calls of the profiled runs
+};
+
+// per-function data of the json report
+struct FunctionRecord {
+  const llvm::Function *Func = nullptr;
+  unsigned Categories = IOC_NONE;
+  IOHotness Hotness;
+  unsigned NumInstructions = 0;
+  uint64_t AnalysisTime = 0; // in nanoseconds
+  llvm::StringRef Source;
+  IOTrigger Trigger;
+};
+
+void WriteJSONString(llvm::raw_ostream &OS, llvm::StringRef Str) {
+  OS << '"';
 
-void ReportStats(void) {
-  PLUGIN_OUT << NumFunctionsProcessed << "\n";
-  PLUGIN_OUT << NumAttributeApplications << "\n";
+  for (const auto c : Str) {
+    if ('"' == c || '\\' == c)
+      OS << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      OS << llvm::format("\\u%04x", c);
+    else
+      OS << c;
+  }
+
+  OS << '"';
+
+  return;
+}
 
-  for (const auto &name : FunctionsAltered)
-    PLUGIN_OUT << name << "\n";
+// the functions that were not scanned due to the budget
+void WriteSkippedFunctions(llvm::raw_ostream &OS, const ModuleStats &Stats) {
+  OS << "[";
+
+  const char *sep = "";
+  for (std::size_t i = 0; i < Stats.OverBudget.size(); ++i)
+    if (Stats.OverBudget[i]) {
+      OS << sep;
+      WriteJSONString(OS, Stats.WorkList[i]->getName());
+      sep = ", ";
+    }
+
+  OS << "]";
 
   return;
 }
 
-void ReportStats(const char *Filename) {
+void WriteHotness(llvm::raw_ostream &OS, const IOHotness &Hotness) {
+  OS << llvm::format("%.2f", Hotness.Frequency);
+
+  if (Hotness.HasCount)
+    OS << " " << Hotness.Count;
+
+  return;
+}
+
+// the hottest functions are listed after the altered ones
+void WriteStats(llvm::raw_ostream &OS, const ModuleStats &Stats,
+                const std::vector<IOHotness> &Ranking) {
+  OS << Stats.NumFunctionsProcessed << "\n";
+  OS << Stats.NumAttributeApplications << "\n";
+
+  for (std::size_t i = 0; i < Stats.WorkList.size(); ++i)
+    if (Stats.Verdicts[i])
+      OS << Stats.WorkList[i]->getName() << "\n";
+
+  for (const auto &hotness : Ranking) {
+    OS << "hot: " << hotness.Func->getName() << " ";
+    WriteHotness(OS, hotness);
+    OS << "\n";
+  }
+
+  for (std::size_t i = 0; i < Stats.OverBudget.size(); ++i)
+    if (Stats.OverBudget[i])
+      OS << "skipped: " << Stats.WorkList[i]->getName() << "\n";
+
+  return;
+}
+
+void WriteStatsJSON(llvm::raw_ostream &OS, const ModuleStats &Stats,
+                    const std::vector<FunctionRecord> &Records,
+                    const std::vector<IOHotness> &Ranking) {
+  OS << "{\n";
+  OS << "  \"functions_processed\": " << Stats.NumFunctionsProcessed << ",\n";
+  OS << "  \"attribute_applications\": " << Stats.NumAttributeApplications
+     << ",\n";
+  OS << "  \"functions\": [";
+
+  for (std::size_t i = 0; i < Records.size(); ++i) {
+    const auto &rec = Records[i];
+
+    OS << (i ? ",\n" : "\n") << "    {\"name\": ";
+    WriteJSONString(OS, rec.Func->getName());
+    OS << ", \"instructions\": " << rec.NumInstructions;
+    OS << ", \"time_ns\": " << rec.AnalysisTime;
+    OS << ", \"io\": " << (rec.Categories ? "true" : "false");
+    OS << ", \"source\": ";
+    WriteJSONString(OS, rec.Source);
+
+    if (rec.Trigger.Callee) {
+      OS << ", \"callee\": ";
+      WriteJSONString(OS, rec.Trigger.Callee->getName());
+      OS << ", \"category\": ";
+      WriteJSONString(OS, getIOKindName(rec.Trigger.Kind));
+    }
+
+    if (rec.Categories) {
+      OS << ", \"categories\": [";
+
+      const char *sep = "";
+      for (unsigned bit = 1; bit & IOC_ALL; bit <<= 1)
+        if (rec.Categories & bit) {
+          OS << sep;
+          WriteJSONString(OS, getIOCategoryName(static_cast<IOCategory>(bit)));
+          sep = ", ";
+        }
+
+      OS << "]";
+    }
+
+    if (rec.Hotness.Func) {
+      OS << ", \"io_frequency\": "
+         << llvm::format("%.2f", rec.Hotness.Frequency);
+
+      if (rec.Hotness.HasCount)
+        OS << ", \"io_count\": " << rec.Hotness.Count;
+    }
+
+    OS << "}";
+  }
+
+  OS << "\n  ]";
+
+  if (!Ranking.empty()) {
+    OS << ",\n  \"hot_functions\": [";
+
+    for (std::size_t i = 0; i < Ranking.size(); ++i) {
+      OS << (i ? ", " : "");
+      WriteJSONString(OS, Ranking[i].Func->getName());
+    }
+
+    OS << "]";
+  }
+
+  if (std::count(Stats.OverBudget.begin(), Stats.OverBudget.end(), true)) {
+    OS << ",\n  \"skipped_functions\": ";
+    WriteSkippedFunctions(OS, Stats);
+  }
+
+  OS << "\n}\n";
+
+  return;
+}
+
+void WriteStats(llvm::raw_ostream &OS, const ModuleStats &Stats,
+                const std::vector<FunctionRecord> &Records,
+                const std::vector<IOHotness> &Ranking) {
+  if (ReportFormatKind::JSON == ReportFormat)
+    WriteStatsJSON(OS, Stats, Records, Ranking);
+  else
+    WriteStats(OS, Stats, Ranking);
+
+  return;
+}
+
+void ReportStats(const char *Filename, const ModuleStats &Stats,
+                 const std::vector<FunctionRecord> &Records,
+                 const std::vector<IOHotness> &Ranking) {
   const char *stdout_marker = "--";
   if (0 == std::strncmp(stdout_marker, Filename, strlen(stdout_marker))) {
-    ReportStats();
+    WriteStats(PLUGIN_OUT, Stats, Records, Ranking);
 
     return;
   }
 
   std::error_code err;
 
-  llvm::raw_fd_ostream report(Filename, err, llvm::sys::fs::F_Text);
+  llvm::raw_fd_ostream report(Filename, err, llvm::sys::fs::OF_Text);
 
   if (err)
     PLUGIN_ERR << "could not open file: \"" << ReportStatsFilename
                << "\" reason: " << err.message() << "\n";
-  else {
-    report << NumFunctionsProcessed << "\n";
-    report << NumAttributeApplications << "\n";
+  else
+    WriteStats(report, Stats, Records, Ranking);
+
+  return;
+}
+
+// each module adds a single json line with one unbuffered write to a file
+// opened for appending, so that the records of concurrent compilations do
+// not interleave; only the record of the current module is held in memory
+void AppendAggregateStats(const char *Filename, const llvm::Module &M,
+                          const ModuleStats &Stats) {
+  std::string record;
+  llvm::raw_string_ostream recordOS(record);
+
+  recordOS << "{\"module\": ";
+  WriteJSONString(recordOS, M.getModuleIdentifier());
+  recordOS << ", \"functions_processed\": " << Stats.NumFunctionsProcessed;
+  recordOS << ", \"attribute_applications\": "
+           << Stats.NumAttributeApplications;
+  recordOS << ", \"functions_altered\": [";
+
+  const char *sep = "";
+  for (std::size_t i = 0; i < Stats.WorkList.size(); ++i)
+    if (Stats.Verdicts[i]) {
+      recordOS << sep;
+      WriteJSONString(recordOS, Stats.WorkList[i]->getName());
+      sep = ", ";
+    }
+
+  recordOS << "], \"functions_skipped\": ";
+  WriteSkippedFunctions(recordOS, Stats);
+  recordOS << "}\n";
+  recordOS.flush();
+
+  std::error_code err;
+  llvm::raw_fd_ostream aggregate(
+      Filename, err, llvm::sys::fs::OF_Append | llvm::sys::fs::OF_Text);
+
+  if (err) {
+    PLUGIN_ERR << "could not open file: \"" << Filename
+               << "\" reason: " << err.message() << "\n";
+
+    return;
+  }
+
+  aggregate.SetUnbuffered();
+  aggregate << record;
+
+  return;
+}
+
+// the integer frequencies of the block frequency info are scaled to a small
+// entry frequency and truncated, which loses a fraction of each loop
+// iteration, so the floating point frequencies are used instead
+using FloatingBlockFrequencyInfo =
+    llvm::BlockFrequencyInfoImpl<llvm::BasicBlock>;
+
+double GetBlockFrequency(const FloatingBlockFrequencyInfo &BFI,
+                         const llvm::BasicBlock &BB) {
+  const auto freq = BFI.getFloatingBlockFreq(&BB);
+
+  return std::ldexp(static_cast<double>(freq.getDigits()), freq.getScale());
+}
+
+// weights each IO call site by the frequency of its block relative to the
+// function entry, which takes into account the branch weights of a profile;
+// the loops are tagged with the share of their own sites
+IOHotness EstimateIOHotness(llvm::Function &Func,
+                            llvm::ArrayRef<const llvm::Instruction *> Sites,
+                            const FloatingBlockFrequencyInfo &BFI,
+                            const llvm::LoopInfo &LI,
+                            const ApplyIOAttribute &AIOAttr) {
+  IOHotness hotness;
+  hotness.Func = &Func;
+
+  const auto entryFreq = GetBlockFrequency(BFI, Func.getEntryBlock());
+  if (!entryFreq)
+    return hotness;
+
+  const auto entryCount = Func.getEntryCount();
+  hotness.HasCount = entryCount.hasValue();
+
+  double count = 0;
+  llvm::DenseMap<const llvm::Loop *, double> loopFreqs;
+
+  for (const auto *site : Sites) {
+    const auto *bb = site->getParent();
+    const auto freq = GetBlockFrequency(BFI, *bb) / entryFreq;
+
+    hotness.Frequency += freq;
+
+    if (hotness.HasCount)
+      count += freq * entryCount->getCount();
+
+    for (const auto *L = LI.getLoopFor(bb); L; L = L->getParentLoop())
+      loopFreqs[L] += freq;
+  }
+
+  hotness.Count = std::llround(count);
+
+  for (auto *L : LI.getLoopsInPreorder())
+    if (loopFreqs.count(L))
+      AIOAttr.applyIOFrequency(*L, loopFreqs.lookup(L));
+
+  AIOAttr.applyIOFrequency(Func, hotness.Frequency,
+                           hotness.HasCount ? &hotness.Count : nullptr);
+
+  return hotness;
+}
+
+// the instructions are counted only up to the budget
+bool ExceedsInstructionBudget(const llvm::Function &Func, unsigned Budget) {
+  std::size_t numInsts = 0;
+
+  for (const auto &bb : Func) {
+    numInsts += bb.size();
+
+    if (numInsts > Budget)
+      return true;
+  }
+
+  return false;
+}
+
+void LoadBWList(const std::string &Filename, BWList &List) {
+  std::ifstream listFile{Filename};
 
-    for (const auto &name : FunctionsAltered)
-      report << name << "\n";
+  if (!listFile.is_open()) {
+    PLUGIN_ERR << "could not open file: \'" << Filename << "\'\n";
+
+    return;
+  }
+
+  List.addRegex(listFile);
+  List.compile();
+
+  return;
+}
+
+// the sites are named after their function and callee, and their source line
+// when debug info is present, or else their position in the function
+std::string GetIOSiteName(const llvm::Instruction &Site, unsigned Ordinal) {
+  std::string name = Site.getFunction()->getName().str();
+  const auto *call = llvm::dyn_cast<llvm::CallBase>(&Site);
+  const auto *callee = call ? call->getCalledFunction() : nullptr;
+
+  name += ":";
+  name += callee ? callee->getName().str() : "<indirect>";
+
+  if (const auto &loc = Site.getDebugLoc())
+    name += ":" + std::to_string(loc.getLine());
+  else
+    name += "#" + std::to_string(Ordinal);
+
+  return name;
+}
+
+void CollectIOSummary(const llvm::Module &M, const ApplyIOAttribute &AIOAttr,
+                      IOSummary &Summary) {
+  for (const auto &func : M) {
+    if (func.isDeclaration())
+      continue;
+
+    std::vector<uint64_t> callees;
+
+    for (const auto &bb : func)
+      for (const auto &inst : bb) {
+        const auto *call = llvm::dyn_cast<llvm::CallBase>(&inst);
+        if (!call)
+          continue;
+
+        const auto *callee = llvm::dyn_cast<llvm::Function>(
+            call->getCalledOperand()->stripPointerCasts());
+        if (callee && !callee->isIntrinsic())
+          callees.push_back(callee->getGUID());
+      }
+
+    llvm::SmallVector<const llvm::Function *, 8> indirectCallees;
+    AIOAttr.getIndirectCallees(func, indirectCallees);
+
+    for (const auto *callee : indirectCallees)
+      callees.push_back(callee->getGUID());
+
+    Summary.add(func.getGUID(), AIOAttr.hasIO(func), std::move(callees));
   }
 
   return;
@@ -171,52 +733,495 @@ void ReportStats(const char *Filename) {
 
 void ApplyIOAttributePass::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
   AU.addRequired<llvm::TargetLibraryInfoWrapperPass>();
-  AU.setPreservesCFG();
+
+  if (InterproceduralMode || NoIOMode)
+    AU.addRequired<llvm::CallGraphWrapperPass>();
+
+  if (HotnessMode)
+    AU.addRequired<llvm::LoopInfoWrapperPass>();
+
+  // the instrumentation splits the edges of invokes
+  if (!InstrumentMode)
+    AU.setPreservesCFG();
 
   return;
 }
 
 bool ApplyIOAttributePass::runOnModule(llvm::Module &M) {
-  bool shouldReportStats = !ReportStatsFilename.empty();
+  if (M.empty())
+    return false;
+
+  // the time budget starts with the loading of the function lists
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(BudgetMilliseconds);
+  auto exceedsBudget = [&deadline](const llvm::Function &Func) {
+    return (BudgetInstructions &&
+            ExceedsInstructionBudget(Func, BudgetInstructions)) ||
+           (BudgetMilliseconds && std::chrono::steady_clock::now() > deadline);
+  };
+  bool shouldReportStats =
+      !ReportStatsFilename.empty() || !AggregateStatsFilename.empty();
+  ModuleStats stats;
   bool hasChanged = false;
-  const auto &TLI = getAnalysis<llvm::TargetLibraryInfoWrapperPass>().getTLI();
+  // the library functions of a module are taken from its first function,
+  // since the analysis needs a single view of them
+  const auto &TLI =
+      getAnalysis<llvm::TargetLibraryInfoWrapperPass>().getTLI(*M.begin());
   ApplyIOAttribute aioattr(TLI);
 
   BWList funcWhileList;
   if (!FuncWhileListFilename.empty()) {
-    std::ifstream funcWhiteListFile{FuncWhileListFilename};
+    llvm::NamedRegionTimer timer("whitelist", "Load function whitelist",
+                                 TimerGroupName, TimerGroupDesc,
+                                 llvm::TimePassesIsEnabled);
+    llvm::TimeTraceScope traceScope("AIOAttrWhitelist", FuncWhileListFilename);
+
+    LoadBWList(FuncWhileListFilename, funcWhileList);
+  }
 
-    if (funcWhiteListFile.is_open()) {
-      funcWhileList.addRegex(funcWhiteListFile);
-      funcWhiteListFile.close();
+  BWList funcBlackList;
+  if (!FuncBlackListFilename.empty()) {
+    llvm::NamedRegionTimer timer("blacklist", "Load function blacklist",
+                                 TimerGroupName, TimerGroupDesc,
+                                 llvm::TimePassesIsEnabled);
+    llvm::TimeTraceScope traceScope("AIOAttrBlacklist", FuncBlackListFilename);
+
+    LoadBWList(FuncBlackListFilename, funcBlackList);
+  }
+
+  // facts about functions of other modules are attached to their
+  // declarations, so that they are picked up like any other IO declaration
+  std::set<uint64_t> thinLTOFacts;
+  if (!ThinLTOFactsFilename.empty()) {
+    if (IOSummary::readFacts(ThinLTOFactsFilename, thinLTOFacts)) {
+      for (auto &func : M)
+        if (func.isDeclaration() && thinLTOFacts.count(func.getGUID()))
+          hasChanged |= aioattr.apply(func);
     } else
-      PLUGIN_ERR << "could not open file: \'" << FuncWhileListFilename
+      PLUGIN_ERR << "could not read file: \'" << ThinLTOFactsFilename
                  << "\'\n";
   }
 
+  aioattr.classify(M);
+
+  if (!ThinLTOSummaryFilename.empty()) {
+    IOSummary summary;
+    CollectIOSummary(M, aioattr, summary);
+
+    if (!summary.write(ThinLTOSummaryFilename))
+      PLUGIN_ERR << "could not open file: \'" << ThinLTOSummaryFilename
+                 << "\'\n";
+  }
+
+  // the use-list engine falls back to walking the whole module when indirect
+  // calls may reach an IO declaration
+  FunctionIOSiteMap ioSites;
+  bool useSites = false;
+  if (IOEngine != IOEngineKind::WALK) {
+    useSites = aioattr.collectIOSites(M, ioSites);
+
+    if (!useSites) {
+      NumUseListFallbacks++;
+      LLVM_DEBUG(llvm::dbgs() << "use-list engine falls back to walk for "
+                                 "module: "
+                              << M.getName() << "\n");
+    }
+  }
+
+  // the verification compares the local verdicts of both engines and then
+  // continues with the walk
+  if (useSites && IOEngineKind::VERIFY == IOEngine) {
+    for (const auto &func : M) {
+      if (func.isDeclaration())
+        continue;
+
+      IOTrigger trigger;
+      const auto found = ioSites.find(&func);
+      const auto siteCategories =
+          found != ioSites.end() ? aioattr.getIOCategories(found->second,
+                                                           trigger)
+                                 : static_cast<unsigned>(IOC_NONE);
+      const auto walkCategories = aioattr.getIOCategories(func);
+
+      if (siteCategories != walkCategories)
+        PLUGIN_ERR << "engine mismatch for function: \'" << func.getName()
+                   << "\' walk: " << walkCategories
+                   << " uselist: " << siteCategories << "\n";
+    }
+
+    useSites = false;
+  }
+
+  // the functions over the budget are not scanned and get all categories as
+  // their local summary, which then reaches their callers
+  FunctionIOMap ioSummaries;
+  llvm::SmallPtrSet<const llvm::Function *, 8> overBudgetSummaries;
+  if (InterproceduralMode) {
+    FunctionIOMap localSummaries;
+
+    for (const auto &func : M) {
+      if (func.isDeclaration())
+        continue;
+
+      IOTrigger trigger;
+
+      if (exceedsBudget(func)) {
+        localSummaries[&func] = IOC_ALL;
+        overBudgetSummaries.insert(&func);
+      } else if (!useSites)
+        localSummaries[&func] = aioattr.getIOCategories(func, trigger);
+      else {
+        const auto found = ioSites.find(&func);
+        if (found != ioSites.end())
+          localSummaries[&func] =
+              aioattr.getIOCategories(found->second, trigger);
+      }
+    }
+
+    aioattr.propagate(getAnalysis<llvm::CallGraphWrapperPass>().getCallGraph(),
+                      ioSummaries, &localSummaries);
+  }
+
+  std::vector<llvm::Function *> workList;
+
   for (auto &func : M) {
-    if (!FuncWhileListFilename.empty() &&
-        !funcWhileList.matches(func.getName().data()))
+    if (func.isDeclaration())
       continue;
 
-    if (func.isDeclaration())
+    // past the deadline, the functions are not matched against the lists
+    // and conservatively get all categories below, like the ones not scanned
+    const bool isPastDeadline =
+        BudgetMilliseconds && std::chrono::steady_clock::now() > deadline;
+
+    if (!isPastDeadline && !FuncWhileListFilename.empty() &&
+        !funcWhileList.matches(func.getName().data())) {
+      NumWhitelistRejections++;
+
+      continue;
+    }
+
+    if (!isPastDeadline && !FuncBlackListFilename.empty() &&
+        funcBlackList.matches(func.getName().data())) {
+      NumBlacklistRejections++;
+
       continue;
+    }
+
+    NumProcessed++;
 
     if (shouldReportStats)
-      NumFunctionsProcessed++;
+      stats.NumFunctionsProcessed++;
+
+    if (!func.hasFnAttribute(aioattr.getIOAttr()))
+      workList.push_back(&func);
+  }
+
+  // the IO categories are collected per function and applied serially in
+  // module order afterwards, so that the output does not depend on the thread
+  // schedule
+  std::vector<unsigned> verdicts(workList.size(), IOC_NONE);
 
-    if (!func.hasFnAttribute(aioattr.getIOAttr()) && aioattr.hasIO(func)) {
-      hasChanged |= aioattr.apply(func);
+  // the functions over the budget are not scanned and conservatively get all
+  // categories; the deadline is checked before each function, so that a
+  // single function may still overrun it
+  std::vector<char> overBudget(workList.size(), false);
 
-      if (shouldReportStats) {
-        NumAttributeApplications++;
-        FunctionsAltered.insert(func.getName());
+  // the cache holds local verdicts only, which the interprocedural mode
+  // does not use; the use-list engine does not need it
+  const bool useCache =
+      !CacheDirectory.empty() && !InterproceduralMode && !useSites;
+  IOCache cache(CacheDirectory);
+  std::vector<uint64_t> cacheKeys;
+  std::vector<char> cacheMisses;
+
+  if (useCache) {
+    cache.load();
+    cacheKeys.resize(workList.size());
+    cacheMisses.resize(workList.size(), false);
+  }
+
+  const bool shouldRecord =
+      !ReportStatsFilename.empty() && ReportFormatKind::JSON == ReportFormat;
+  std::vector<FunctionRecord> records(shouldRecord ? workList.size() : 0);
+
+  auto analyzeBody = [&](std::size_t i, IOTrigger &Trigger,
+                         llvm::StringRef &Source) {
+    const auto &func = *workList[i];
+
+    if (InterproceduralMode) {
+      Source = "interprocedural";
+
+      if (overBudgetSummaries.count(&func)) {
+        Source = "budget";
+        overBudget[i] = true;
       }
+
+      return ioSummaries.lookup(&func);
+    }
+
+    // a cache hit needs no classification of the calls, so it is looked up
+    // before the budget is checked
+    const bool isCacheable = useCache && IOCache::isCacheable(func);
+    if (isCacheable) {
+      unsigned categories;
+      cacheKeys[i] = IOCache::getKey(func, IOCatalogVersion, TLI);
+
+      if (cache.lookup(cacheKeys[i], categories)) {
+        Source = "cache";
+
+        return categories;
+      }
+    }
+
+    if (exceedsBudget(func)) {
+      Source = "budget";
+      overBudget[i] = true;
+
+      return static_cast<unsigned>(IOC_ALL);
+    }
+
+    if (isCacheable)
+      cacheMisses[i] =
+          IOCache::isModuleIndependent(func, aioattr.getIOAttr());
+
+    if (useSites) {
+      Source = "uselist";
+
+      const auto found = ioSites.find(&func);
+
+      return found != ioSites.end()
+                 ? aioattr.getIOCategories(found->second, Trigger)
+                 : static_cast<unsigned>(IOC_NONE);
+    }
+
+    Source = "scan";
+
+    return aioattr.getIOCategories(func, Trigger);
+  };
+
+  // the thin link does not track categories, so a fact about a function adds
+  // all of them only when its body shows no IO; the result then depends on
+  // the facts and is not cached
+  auto analyzeFunction = [&](std::size_t i, IOTrigger &Trigger,
+                             llvm::StringRef &Source) {
+    const auto categories = analyzeBody(i, Trigger, Source);
+
+    if (categories || !thinLTOFacts.count(workList[i]->getGUID()))
+      return categories;
+
+    Source = "thinlto";
+
+    if (useCache)
+      cacheMisses[i] = false;
+
+    return static_cast<unsigned>(IOC_ALL);
+  };
+
+  auto analyze = [&](std::size_t Begin, std::size_t End) {
+    for (auto i = Begin; i < End; ++i) {
+      IOTrigger trigger;
+      llvm::StringRef source;
+
+      if (!shouldRecord) {
+        verdicts[i] = analyzeFunction(i, trigger, source);
+
+        continue;
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      verdicts[i] = analyzeFunction(i, trigger, source);
+      const auto end = std::chrono::steady_clock::now();
+
+      auto &rec = records[i];
+      rec.Func = workList[i];
+      rec.Categories = verdicts[i];
+      rec.AnalysisTime =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+              .count();
+      rec.Source = source;
+      rec.Trigger = trigger;
+
+      for (const auto &bb : *workList[i])
+        rec.NumInstructions += bb.size();
+    }
+  };
+
+  {
+    llvm::NamedRegionTimer timer("scan", "Scan functions", TimerGroupName,
+                                 TimerGroupDesc, llvm::TimePassesIsEnabled);
+    llvm::TimeTraceScope traceScope("AIOAttrScan", M.getName());
+
+    if (NumThreads > 1 && !InterproceduralMode) {
+      llvm::ThreadPool pool(llvm::hardware_concurrency(NumThreads));
+
+      // use a few shards per thread to even out functions of uneven size
+      const std::size_t numShards = NumThreads * 4;
+      const auto shardSize = (workList.size() + numShards - 1) / numShards;
+
+      for (std::size_t i = 0; i < workList.size(); i += shardSize)
+        pool.async(analyze, i, std::min(i + shardSize, workList.size()));
+
+      pool.wait();
+    } else
+      analyze(0, workList.size());
+  }
+
+  if (useCache) {
+    for (std::size_t i = 0; i < workList.size(); ++i)
+      if (cacheMisses[i])
+        cache.insert(cacheKeys[i], verdicts[i]);
+
+    if (!cache.store())
+      PLUGIN_ERR << "could not update cache in: \'" << CacheDirectory
+                 << "\'\n";
+  }
+
+  {
+    llvm::NamedRegionTimer timer("apply", "Apply attributes", TimerGroupName,
+                                 TimerGroupDesc, llvm::TimePassesIsEnabled);
+    llvm::TimeTraceScope traceScope("AIOAttrApply", M.getName());
+
+    for (std::size_t i = 0; i < workList.size(); ++i) {
+      if (!verdicts[i])
+        continue;
+
+      auto &func = *workList[i];
+      NumApplied++;
+
+      if (shouldReportStats)
+        stats.NumAttributeApplications++;
+
+      if (overBudget[i]) {
+        hasChanged |= aioattr.applyIOUnknown(func);
+        NumOverBudget++;
+      } else
+        hasChanged |= aioattr.apply(func, verdicts[i]);
+    }
+  }
+
+  // the block frequencies are computed on demand for each function with IO,
+  // which must happen serially
+  std::vector<IOHotness> ranking;
+  if (HotnessMode) {
+    llvm::NamedRegionTimer timer("hotness", "Estimate IO hotness",
+                                 TimerGroupName, TimerGroupDesc,
+                                 llvm::TimePassesIsEnabled);
+    llvm::TimeTraceScope traceScope("AIOAttrHotness", M.getName());
+
+    for (std::size_t i = 0; i < workList.size(); ++i) {
+      if (!verdicts[i] || overBudget[i])
+        continue;
+
+      auto &func = *workList[i];
+      llvm::SmallVector<const llvm::Instruction *, 8> sites;
+      aioattr.getIOSites(func, sites);
+
+      // the calls to functions with IO count as IO sites as well
+      if (InterproceduralMode)
+        for (const auto &bb : func)
+          for (const auto &inst : bb) {
+            const auto *call = llvm::dyn_cast<llvm::CallBase>(&inst);
+            const auto *callee = call ? call->getCalledFunction() : nullptr;
+
+            if (callee && !callee->isDeclaration() &&
+                ioSummaries.lookup(callee))
+              sites.push_back(&inst);
+          }
+
+      // the frequencies are computed over the loop info of the pass manager,
+      // since each on-the-fly analysis request recomputes all the function
+      // analyses the pass requires
+      const auto &LI =
+          getAnalysis<llvm::LoopInfoWrapperPass>(func).getLoopInfo();
+      llvm::BranchProbabilityInfo BPI(func, LI, &TLI);
+      FloatingBlockFrequencyInfo BFI;
+      BFI.calculate(func, BPI, LI);
+      ranking.push_back(EstimateIOHotness(func, sites, BFI, LI, aioattr));
+
+      if (shouldRecord)
+        records[i].Hotness = ranking.back();
+    }
+
+    // the functions with a profile count rank before the rest
+    std::stable_sort(ranking.begin(), ranking.end(),
+                     [](const IOHotness &LHS, const IOHotness &RHS) {
+                       if (LHS.Count != RHS.Count)
+                         return LHS.Count > RHS.Count;
+
+                       return LHS.Frequency > RHS.Frequency;
+                     });
+  }
+
+  // the proof does not depend on the verdicts above, but a function with IO
+  // can never be proven IO-free
+  if (NoIOMode) {
+    llvm::NamedRegionTimer timer("noio", "Prove absence of IO", TimerGroupName,
+                                 TimerGroupDesc, llvm::TimePassesIsEnabled);
+    llvm::TimeTraceScope traceScope("AIOAttrNoIO", M.getName());
+
+    FunctionNoIOMap noIOFuncs;
+    aioattr.proveNoIO(getAnalysis<llvm::CallGraphWrapperPass>().getCallGraph(),
+                      noIOFuncs);
+
+    for (std::size_t i = 0; i < workList.size(); ++i) {
+      auto &func = *workList[i];
+      const auto found = noIOFuncs.find(&func);
+
+      if (verdicts[i] || found == noIOFuncs.end() ||
+          func.hasFnAttribute(aioattr.getNoIOAttr()))
+        continue;
+
+      hasChanged |= aioattr.applyNoIO(func, found->second);
+      NumNoIOApplied++;
+
+      if (found->second)
+        NumNoSyncApplied++;
     }
   }
 
-  if (shouldReportStats)
-    ReportStats(ReportStatsFilename.c_str());
+  // the sites are collected before any probe is inserted, so that the probes
+  // are never instrumented themselves
+  if (InstrumentMode) {
+    llvm::NamedRegionTimer timer("instrument", "Instrument IO call sites",
+                                 TimerGroupName, TimerGroupDesc,
+                                 llvm::TimePassesIsEnabled);
+    llvm::TimeTraceScope traceScope("AIOAttrInstrument", M.getName());
+
+    IOInstrumentation instrumentation(M);
+
+    for (std::size_t i = 0; i < workList.size(); ++i) {
+      if (!verdicts[i] || overBudget[i])
+        continue;
+
+      llvm::SmallVector<const llvm::Instruction *, 8> sites;
+      aioattr.getIOSites(*workList[i], sites);
+
+      for (std::size_t j = 0; j < sites.size(); ++j) {
+        auto &site = const_cast<llvm::Instruction &>(*sites[j]);
+
+        if (instrumentation.instrument(site, GetIOSiteName(site, j)))
+          NumSitesInstrumented++;
+      }
+    }
+
+    hasChanged |= instrumentation.finalize();
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "classification cache hits: "
+                          << aioattr.getNumClassificationHits() << " misses: "
+                          << aioattr.getNumClassificationMisses() << "\n");
+
+  if (shouldReportStats) {
+    stats.WorkList = workList;
+    stats.Verdicts = verdicts;
+    stats.OverBudget = overBudget;
+  }
+
+  if (!ReportStatsFilename.empty())
+    ReportStats(ReportStatsFilename.c_str(), stats, records, ranking);
+
+  if (!AggregateStatsFilename.empty())
+    AppendAggregateStats(AggregateStatsFilename.c_str(), M, stats);
 
   return hasChanged;
 }
@@ -0,0 +1,99 @@
+//
+//
+//
+
+#define DEBUG_TYPE "applyioloopattribute"
+
+#include "llvm/Pass.h"
+// using llvm::RegisterPass
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+// using llvm::LoopInfo
+// using llvm::LoopInfoWrapperPass
+
+#include "llvm/Analysis/TargetLibraryInfo.h"
+// using llvm::TargetLibraryInfoWrapperPass
+
+#include "Config.hpp"
+
+#include "ApplyIOLoopAttributePass.hpp"
+
+// plugin registration for opt
+
+#define STRINGIFY_UTIL(x) #x
+#define STRINGIFY(x) STRINGIFY_UTIL(x)
+
+#define PRJ_CMDLINE_DESC(x)                                                    \
+  x " (version: " STRINGIFY(APPLYIOATTRIBUTE_VERSION) ")"
+
+char icsa::ApplyIOLoopAttributePass::ID = 0;
+static llvm::RegisterPass<icsa::ApplyIOLoopAttributePass>
+    X("apply-io-loop-attribute",
+      PRJ_CMDLINE_DESC("apply IO loop metadata pass"), false, false);
+
+namespace icsa {
+
+namespace {
+
+bool applyToLoopNest(const ApplyIOAttribute &AIOAttr, llvm::Loop &L,
+                     const LoopIOMap &LoopSummaries) {
+  bool hasChanged = AIOAttr.apply(L, LoopSummaries.lookup(&L));
+
+  for (auto *subLoop : L.getSubLoops())
+    hasChanged |= applyToLoopNest(AIOAttr, *subLoop, LoopSummaries);
+
+  return hasChanged;
+}
+
+} // namespace anonymous end
+
+bool ApplyIOLoopAttributePass::doInitialization(llvm::Module &M) {
+  m_AIOAttr.reset();
+
+  return false;
+}
+
+bool ApplyIOLoopAttributePass::doFinalization(llvm::Module &M) {
+  m_AIOAttr.reset();
+
+  return false;
+}
+
+void ApplyIOLoopAttributePass::getAnalysisUsage(
+    llvm::AnalysisUsage &AU) const {
+  AU.addRequired<llvm::TargetLibraryInfoWrapperPass>();
+  AU.addRequired<llvm::LoopInfoWrapperPass>();
+  AU.setPreservesAll();
+
+  return;
+}
+
+bool ApplyIOLoopAttributePass::runOnFunction(llvm::Function &F) {
+  bool hasChanged = false;
+
+  if (!m_AIOAttr) {
+    const auto &TLI =
+        getAnalysis<llvm::TargetLibraryInfoWrapperPass>().getTLI(F);
+    m_AIOAttr.reset(new ApplyIOAttribute(TLI));
+    m_AIOAttr->classify(*F.getParent());
+  }
+
+  auto &LI = getAnalysis<llvm::LoopInfoWrapperPass>().getLoopInfo();
+  LoopIOMap loopSummaries;
+
+  for (auto *L : LI) {
+    m_AIOAttr->hasIO(*L, LI, loopSummaries);
+    hasChanged |= applyToLoopNest(*m_AIOAttr, *L, loopSummaries);
+  }
+
+  return hasChanged;
+}
+
+} // namespace icsa end
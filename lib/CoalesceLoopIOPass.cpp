@@ -0,0 +1,321 @@
+//
+//
+//
+
+#include "llvm/Pass.h"
+// using llvm::RegisterPass
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/BasicBlock.h"
+// using llvm::BasicBlock
+
+#include "llvm/IR/Instructions.h"
+// using llvm::CallInst
+
+#include "llvm/IR/IntrinsicInst.h"
+// using llvm::IntrinsicInst
+// using llvm::DbgInfoIntrinsic
+
+#include "llvm/IR/Intrinsics.h"
+// using llvm::Intrinsic::ID
+
+#include "llvm/IR/IRBuilder.h"
+// using llvm::IRBuilder
+
+#include "llvm/IR/DerivedTypes.h"
+// using llvm::ArrayType
+// using llvm::IntegerType
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+// using llvm::LoopInfo
+// using llvm::LoopInfoWrapperPass
+
+#include "llvm/Analysis/TargetLibraryInfo.h"
+// using llvm::TargetLibraryInfoWrapperPass
+// using llvm::TargetLibraryInfo
+// using llvm::LibFunc
+
+#include "llvm/Transforms/Utils.h"
+// using llvm::LoopSimplifyID
+
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+// using llvm::SplitBlockAndInsertIfThen
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/ADT/Statistic.h"
+// using STATISTIC macro
+
+#include "llvm/Support/CommandLine.h"
+// using llvm::cl::opt
+
+#include "llvm/Support/Casting.h"
+// using llvm::dyn_cast
+
+#include <vector>
+// using std::vector
+
+#include "Config.hpp"
+
+#include "ApplyIOAttribute.hpp"
+
+#include "CoalesceLoopIOPass.hpp"
+
+// some of the above headers undefine it
+#define DEBUG_TYPE "coalesceloopio"
+
+// plugin registration for opt
+
+#define STRINGIFY_UTIL(x) #x
+#define STRINGIFY(x) STRINGIFY_UTIL(x)
+
+#define PRJ_CMDLINE_DESC(x)                                                    \
+  x " (version: " STRINGIFY(APPLYIOATTRIBUTE_VERSION) ")"
+
+char icsa::CoalesceLoopIOPass::ID = 0;
+static llvm::RegisterPass<icsa::CoalesceLoopIOPass>
+    X("coalesce-loop-io",
+      PRJ_CMDLINE_DESC("coalesce loop character writes pass"), false, false);
+
+static llvm::cl::opt<unsigned> BufferSize(
+    "aioattr-coalesce-buffer",
+    llvm::cl::desc("size of the stack buffer of coalesced loop writes"),
+    llvm::cl::init(1024));
+
+STATISTIC(NumLoopsCoalesced, "Number of loops with coalesced writes");
+STATISTIC(NumWritesCoalesced, "Number of coalesced character writes");
+
+namespace icsa {
+
+namespace {
+
+struct CoalescingCandidate {
+  llvm::Loop *L = nullptr;
+  llvm::Value *Stream = nullptr;
+  llvm::SmallVector<llvm::CallInst *, 4> Writes;
+};
+
+// putchar is not handled, since the loop might change stdout between its
+// calls and the flush
+bool isCharWrite(const llvm::CallInst &Call,
+                 const llvm::TargetLibraryInfo &TLI) {
+  const auto *callee = Call.getCalledFunction();
+  llvm::LibFunc TLIFunc;
+
+  if (!callee || !TLI.getLibFunc(callee->getName(), TLIFunc) ||
+      !TLI.has(TLIFunc))
+    return false;
+
+  return (llvm::LibFunc_fputc == TLIFunc || llvm::LibFunc_putc == TLIFunc) &&
+         2 == Call.arg_size();
+}
+
+// only the intrinsics that are no calls at run time are accepted
+bool isAnnotation(const llvm::IntrinsicInst &Intrinsic) {
+  if (llvm::isa<llvm::DbgInfoIntrinsic>(Intrinsic))
+    return true;
+
+  switch (Intrinsic.getIntrinsicID()) {
+  case llvm::Intrinsic::lifetime_start:
+  case llvm::Intrinsic::lifetime_end:
+  case llvm::Intrinsic::assume:
+  case llvm::Intrinsic::experimental_noalias_scope_decl:
+  case llvm::Intrinsic::invariant_start:
+  case llvm::Intrinsic::invariant_end:
+  case llvm::Intrinsic::pseudoprobe:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// the buffered characters are lost if the loop is left without passing
+// through an exit block, so any other call must be proven IO-free and must
+// not unwind
+bool isCoalescingSafe(const llvm::CallInst &Call,
+                      const ApplyIOAttribute &AIOAttr) {
+  if (const auto *intrinsic = llvm::dyn_cast<llvm::IntrinsicInst>(&Call))
+    return isAnnotation(*intrinsic);
+
+  const auto *callee = Call.getCalledFunction();
+
+  return callee && callee->hasFnAttribute(AIOAttr.getNoIOAttr()) &&
+         Call.doesNotThrow();
+}
+
+bool getCandidate(llvm::Loop &L, const llvm::TargetLibraryInfo &TLI,
+                  const ApplyIOAttribute &AIOAttr,
+                  CoalescingCandidate &Candidate) {
+  if (!L.getLoopPreheader() || !L.hasDedicatedExits() || !AIOAttr.hasIO(L))
+    return false;
+
+  for (auto bbi = L.block_begin(), bbe = L.block_end(); bbi != bbe; ++bbi)
+    for (auto &inst : **bbi) {
+      if (!llvm::isa<llvm::CallBase>(inst))
+        continue;
+
+      auto *call = llvm::dyn_cast<llvm::CallInst>(&inst);
+      if (!call)
+        return false;
+
+      if (!isCharWrite(*call, TLI)) {
+        if (!isCoalescingSafe(*call, AIOAttr))
+          return false;
+
+        continue;
+      }
+
+      // the result of a write reports its failure, which is not known
+      // before the flush
+      auto *stream = call->getArgOperand(1);
+      if (!call->use_empty() || !L.isLoopInvariant(stream))
+        return false;
+
+      if (Candidate.Stream && Candidate.Stream != stream)
+        return false;
+
+      Candidate.Stream = stream;
+      Candidate.Writes.push_back(call);
+    }
+
+  Candidate.L = &L;
+
+  return !Candidate.Writes.empty();
+}
+
+void coalesce(llvm::Function &F, const CoalescingCandidate &Candidate) {
+  auto &ctx = F.getContext();
+  auto &M = *F.getParent();
+  auto *sizeTy = M.getDataLayout().getIntPtrType(ctx);
+  auto *bufTy = llvm::ArrayType::get(llvm::Type::getInt8Ty(ctx), BufferSize);
+  auto *zero = llvm::ConstantInt::get(sizeTy, 0);
+  auto *one = llvm::ConstantInt::get(sizeTy, 1);
+
+  auto fwriteFunc = M.getOrInsertFunction(
+      "fwrite", sizeTy, llvm::Type::getInt8PtrTy(ctx), sizeTy, sizeTy,
+      Candidate.Stream->getType());
+
+  llvm::IRBuilder<> builder(&*F.getEntryBlock().getFirstInsertionPt());
+  auto *buf = builder.CreateAlloca(bufTy, nullptr, "aioattr.buf");
+  auto *len = builder.CreateAlloca(sizeTy, nullptr, "aioattr.len");
+
+  auto flush = [&](llvm::IRBuilder<> &Builder, llvm::Value *Len) {
+    auto *ptr = Builder.CreateConstInBoundsGEP2_32(bufTy, buf, 0, 0);
+    Builder.CreateCall(fwriteFunc, {ptr, one, Len, Candidate.Stream});
+  };
+
+  // the exits are collected before any block of the loop is split
+  llvm::SmallVector<llvm::BasicBlock *, 4> exits;
+  Candidate.L->getUniqueExitBlocks(exits);
+
+  builder.SetInsertPoint(Candidate.L->getLoopPreheader()->getTerminator());
+  builder.CreateStore(zero, len);
+
+  for (auto *write : Candidate.Writes) {
+    builder.SetInsertPoint(write);
+    auto *n = builder.CreateLoad(sizeTy, len);
+    auto *full =
+        builder.CreateICmpEQ(n, llvm::ConstantInt::get(sizeTy, BufferSize));
+
+    {
+      llvm::IRBuilder<> flushBuilder(
+          llvm::SplitBlockAndInsertIfThen(full, write, false));
+      flush(flushBuilder, n);
+    }
+
+    builder.SetInsertPoint(write);
+    auto *idx = builder.CreateSelect(full, zero, n);
+    auto *ptr = builder.CreateInBoundsGEP(bufTy, buf, {zero, idx});
+    builder.CreateStore(
+        builder.CreateTrunc(write->getArgOperand(0), builder.getInt8Ty()),
+        ptr);
+    builder.CreateStore(builder.CreateAdd(idx, one), len);
+
+    write->eraseFromParent();
+  }
+
+  for (auto *exit : exits) {
+    builder.SetInsertPoint(&*exit->getFirstInsertionPt());
+    flush(builder, builder.CreateLoad(sizeTy, len));
+  }
+
+  return;
+}
+
+} // namespace anonymous end
+
+bool CoalesceLoopIOPass::doInitialization(llvm::Module &M) {
+  m_AIOAttr.reset();
+
+  return false;
+}
+
+bool CoalesceLoopIOPass::doFinalization(llvm::Module &M) {
+  m_AIOAttr.reset();
+
+  return false;
+}
+
+void CoalesceLoopIOPass::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
+  AU.addRequired<llvm::TargetLibraryInfoWrapperPass>();
+  AU.addRequired<llvm::LoopInfoWrapperPass>();
+  AU.addRequiredID(llvm::LoopSimplifyID);
+
+  return;
+}
+
+bool CoalesceLoopIOPass::runOnFunction(llvm::Function &F) {
+  if (!BufferSize)
+    return false;
+
+  const auto &TLI =
+      getAnalysis<llvm::TargetLibraryInfoWrapperPass>().getTLI(F);
+
+  // the fwrite declarations added by the coalescing are classified on their
+  // first lookup
+  if (!m_AIOAttr) {
+    m_AIOAttr.reset(new ApplyIOAttribute(TLI));
+    m_AIOAttr->classify(*F.getParent());
+  }
+
+  auto &LI = getAnalysis<llvm::LoopInfoWrapperPass>().getLoopInfo();
+
+  // the outermost eligible loop of each nest is coalesced, so that the
+  // buffer is flushed as rarely as possible
+  std::vector<CoalescingCandidate> candidates;
+  std::vector<llvm::Loop *> workList(LI.begin(), LI.end());
+
+  while (!workList.empty()) {
+    auto *L = workList.back();
+    workList.pop_back();
+
+    CoalescingCandidate candidate;
+    if (getCandidate(*L, TLI, *m_AIOAttr, candidate))
+      candidates.push_back(candidate);
+    else
+      workList.insert(workList.end(), L->begin(), L->end());
+  }
+
+  // splitting blocks invalidates the loop info, so all candidates are found
+  // before any of them is transformed
+  for (const auto &candidate : candidates) {
+    coalesce(F, candidate);
+
+    NumLoopsCoalesced++;
+    NumWritesCoalesced += candidate.Writes.size();
+  }
+
+  return !candidates.empty();
+}
+
+} // namespace icsa end
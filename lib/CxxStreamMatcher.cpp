@@ -0,0 +1,234 @@
+//
+//
+//
+
+#include <algorithm>
+// using std::find
+
+#include <iterator>
+// using std::begin
+// using std::end
+
+#include <cctype>
+// using std::isdigit
+// using std::islower
+// using std::isupper
+
+#include "CxxStreamMatcher.hpp"
+
+namespace icsa {
+
+namespace {
+
+struct CxxStreamEntry {
+  llvm::StringRef Name;
+  unsigned Categories;
+};
+
+// the stream class templates as they follow the std namespace in a nested
+// name, i.e. _ZNSt<class> for libstdc++ and _ZNSt3__1<class> for libc++, the
+// standard abbreviations of std::ostream, std::istream and std::iostream, the
+// member functions along with the operator<< and operator>> codes, the free
+// functions of the std namespace and the markers of a stream type in their
+// signature
+#define GET_IO_CXX_CATALOG
+#include "IOCatalog.inc"
+#undef GET_IO_CXX_CATALOG
+
+const llvm::StringRef CxxMangledPrefix = "_Z";
+const llvm::StringRef CxxLibCxxNamespace = "3__1";
+const llvm::StringRef CxxLibCxxStdPrefix = "St3__1";
+
+template <typename T> bool contains(const T &Table, llvm::StringRef Name) {
+  return std::end(Table) != std::find(std::begin(Table), std::end(Table), Name);
+}
+
+bool consumeSourceName(llvm::StringRef &Name, llvm::StringRef &Identifier) {
+  std::size_t len = 0;
+
+  while (!Name.empty() && std::isdigit(Name.front())) {
+    len = len * 10 + (Name.front() - '0');
+    Name = Name.drop_front();
+  }
+
+  if (!len || len > Name.size())
+    return false;
+
+  Identifier = Name.substr(0, len);
+  Name = Name.drop_front(len);
+
+  return true;
+}
+
+bool consumeUnqualifiedName(llvm::StringRef &Name, llvm::StringRef &Identifier) {
+  if (Name.empty())
+    return false;
+
+  if (std::isdigit(Name.front()))
+    return consumeSourceName(Name, Identifier);
+
+  // operator codes are two lowercase letters
+  if (Name.size() >= 2 && std::islower(Name[0]) && std::islower(Name[1])) {
+    Identifier = Name.substr(0, 2);
+    Name = Name.drop_front(2);
+
+    return true;
+  }
+
+  return false;
+}
+
+// skips a template argument list by balancing its openers against the 'E'
+// terminators; source names and substitutions are skipped as a whole, since
+// they may contain any of those characters
+bool skipTemplateArgs(llvm::StringRef &Name) {
+  if (!Name.startswith("I"))
+    return true;
+
+  unsigned depth = 0;
+  llvm::StringRef identifier;
+
+  do {
+    if (Name.empty())
+      return false;
+
+    const auto c = Name.front();
+
+    if (std::isdigit(c)) {
+      if (!consumeSourceName(Name, identifier))
+        return false;
+
+      continue;
+    }
+
+    Name = Name.drop_front();
+
+    if (c == 'I' || c == 'N' || c == 'L' || c == 'X')
+      depth++;
+    else if (c == 'E')
+      depth--;
+    else if ((c == 'S' || c == 'T') && !Name.empty()) {
+      if (c == 'S' && std::islower(Name.front()))
+        Name = Name.drop_front();
+      else {
+        while (!Name.empty() &&
+               (std::isdigit(Name.front()) || std::isupper(Name.front())))
+          Name = Name.drop_front();
+
+        if (!Name.startswith("_"))
+          return false;
+
+        Name = Name.drop_front();
+      }
+    }
+  } while (depth);
+
+  return true;
+}
+
+// returns the categories of the consumed stream class
+unsigned consumeStreamClass(llvm::StringRef &Name) {
+  for (const auto &e : CxxStreamAbbreviations)
+    if (Name.startswith(e.Name)) {
+      Name = Name.drop_front(e.Name.size());
+
+      return e.Categories;
+    }
+
+  auto rest = Name;
+  if (!rest.startswith("St"))
+    return IOC_NONE;
+
+  rest = rest.drop_front(2);
+  if (rest.startswith(CxxLibCxxNamespace))
+    rest = rest.drop_front(CxxLibCxxNamespace.size());
+
+  for (const auto &e : CxxStreamClasses)
+    if (rest.startswith(e.Name)) {
+      rest = rest.drop_front(e.Name.size());
+
+      if (!skipTemplateArgs(rest))
+        return IOC_NONE;
+
+      Name = rest;
+
+      return e.Categories;
+    }
+
+  return IOC_NONE;
+}
+
+unsigned getStreamMethodCategories(llvm::StringRef Name) {
+  const auto categories = consumeStreamClass(Name);
+  if (!categories)
+    return IOC_NONE;
+
+  // file streams open and close the file in their constructors and
+  // destructors
+  const auto fileCategories =
+      categories & IOC_CONSOLE ? categories : categories | IOC_FS_METADATA;
+
+  // constructors and destructors
+  if (Name.size() >= 2 && (Name[0] == 'C' || Name[0] == 'D') &&
+      std::isdigit(Name[1]))
+    return Name.drop_front(2).startswith("E") ? fileCategories : IOC_NONE;
+
+  llvm::StringRef method;
+  if (!consumeUnqualifiedName(Name, method) || !Name.startswith("E") ||
+      !contains(CxxStreamMethods, method))
+    return IOC_NONE;
+
+  return contains(CxxFileStreamMethods, method) ? fileCategories : categories;
+}
+
+unsigned getStreamFuncCategories(llvm::StringRef Name) {
+  llvm::StringRef func;
+  if (!consumeUnqualifiedName(Name, func) ||
+      !contains(CxxStreamFuncs, func))
+    return IOC_NONE;
+
+  unsigned categories = IOC_NONE;
+
+  for (const auto &e : CxxStreamTypeMarkers)
+    if (llvm::StringRef::npos != Name.find(e.Name))
+      categories |= e.Categories;
+
+  return categories;
+}
+
+} // namespace anonymous end
+
+unsigned getCxxStreamIOCategories(llvm::StringRef MangledName) {
+  if (!MangledName.startswith(CxxMangledPrefix))
+    return IOC_NONE;
+
+  auto name = MangledName.drop_front(CxxMangledPrefix.size());
+
+  // std::<function>
+  if (name.startswith("St"))
+    return getStreamFuncCategories(name.drop_front(2));
+
+  if (!name.startswith("N"))
+    return IOC_NONE;
+
+  name = name.drop_front();
+
+  // cv-qualified member functions
+  if (name.startswith("K"))
+    name = name.drop_front();
+
+  if (const auto categories = getStreamMethodCategories(name))
+    return categories;
+
+  // std::__1::<function>
+  if (!name.startswith(CxxLibCxxStdPrefix))
+    return IOC_NONE;
+
+  return getStreamFuncCategories(name.drop_front(CxxLibCxxStdPrefix.size()));
+}
+
+bool matchesCxxStreamIO(llvm::StringRef MangledName) {
+  return IOC_NONE != getCxxStreamIOCategories(MangledName);
+}
+
+} // namespace icsa end
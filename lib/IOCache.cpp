@@ -0,0 +1,321 @@
+//
+//
+//
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/InstrTypes.h"
+// using llvm::CallBase
+
+#include "llvm/IR/DerivedTypes.h"
+// using llvm::IntegerType
+// using llvm::StructType
+
+#include "llvm/Analysis/TargetLibraryInfo.h"
+// using llvm::TargetLibraryInfo
+// using llvm::LibFunc
+
+#include "llvm/Support/FileSystem.h"
+// using llvm::sys::fs::createUniqueFile
+// using llvm::sys::fs::rename
+
+#include "llvm/Support/Path.h"
+// using llvm::sys::path::append
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::raw_fd_ostream
+
+#include "llvm/ADT/SmallString.h"
+// using llvm::SmallString
+
+#include <algorithm>
+// using std::lower_bound
+
+#include <vector>
+// using std::vector
+
+#include <cstring>
+// using std::memcmp
+// using std::memcpy
+
+#include "IOCache.hpp"
+
+namespace icsa {
+
+namespace {
+
+const char CacheMagic[8] = {'A', 'I', 'O', 'C', 'A', 'C', 'H', 'E'};
+const uint32_t CacheFormatVersion = 3;
+const char *CacheFilename = "aioattr.cache";
+
+// FNV-1a, since the key has to be stable across processes and hosts
+class StableHasher {
+public:
+  void add(llvm::StringRef Data) {
+    for (const auto c : Data) {
+      m_Hash ^= static_cast<unsigned char>(c);
+      m_Hash *= 0x100000001b3ULL;
+    }
+
+    add(static_cast<uint64_t>(Data.size()));
+  }
+
+  void add(uint64_t Value) {
+    for (unsigned i = 0; i < sizeof(Value); ++i) {
+      m_Hash ^= (Value >> (i * 8)) & 0xff;
+      m_Hash *= 0x100000001b3ULL;
+    }
+  }
+
+  uint64_t get() const { return m_Hash; }
+
+  // named structs are identified by their name, since they may be recursive
+  void add(const llvm::Type &Ty) {
+    add(static_cast<uint64_t>(Ty.getTypeID()));
+
+    if (const auto *intTy = llvm::dyn_cast<llvm::IntegerType>(&Ty))
+      add(static_cast<uint64_t>(intTy->getBitWidth()));
+
+    const auto *structTy = llvm::dyn_cast<llvm::StructType>(&Ty);
+    if (structTy && !structTy->isLiteral()) {
+      add(structTy->getName());
+
+      return;
+    }
+
+    add(static_cast<uint64_t>(Ty.getNumContainedTypes()));
+    for (const auto *contained : Ty.subtypes())
+      add(*contained);
+
+    return;
+  }
+
+private:
+  uint64_t m_Hash = 0xcbf29ce484222325ULL;
+};
+
+// the callee kinds the verdict depends on
+enum CalleeKind : uint64_t {
+  CK_INDIRECT,
+  CK_DEFINITION,
+  CK_DECLARATION,
+  CK_LIBRARY,
+};
+
+} // namespace anonymous end
+
+bool IOCache::isCacheable(const llvm::Function &Func) {
+  return Func.hasName() &&
+         (Func.hasLinkOnceODRLinkage() || Func.hasWeakODRLinkage());
+}
+
+uint64_t IOCache::getKey(const llvm::Function &Func, unsigned CatalogVersion,
+                         const llvm::TargetLibraryInfo &TLI) {
+  StableHasher hasher;
+
+  hasher.add(CatalogVersion);
+  hasher.add(Func.getParent()->getTargetTriple());
+  hasher.add(Func.getName());
+  hasher.add(*Func.getFunctionType());
+
+  for (const auto &bb : Func) {
+    hasher.add(static_cast<uint64_t>(bb.size()));
+
+    for (const auto &inst : bb) {
+      hasher.add(static_cast<uint64_t>(inst.getOpcode()));
+      hasher.add(*inst.getType());
+      hasher.add(static_cast<uint64_t>(inst.getNumOperands()));
+
+      const auto *call = llvm::dyn_cast<llvm::CallBase>(&inst);
+      if (!call)
+        continue;
+
+      hasher.add(*call->getFunctionType());
+
+      const auto *callee = llvm::dyn_cast<llvm::Function>(
+          call->getCalledOperand()->stripPointerCasts());
+      if (!callee) {
+        hasher.add(static_cast<uint64_t>(CK_INDIRECT));
+
+        continue;
+      }
+
+      llvm::LibFunc TLIFunc;
+      auto kind = callee->isDeclaration() ? CK_DECLARATION : CK_DEFINITION;
+
+      if (callee->hasName() && TLI.getLibFunc(callee->getName(), TLIFunc) &&
+          TLI.has(TLIFunc))
+        kind = CK_LIBRARY;
+
+      hasher.add(static_cast<uint64_t>(kind));
+      hasher.add(callee->getName());
+      hasher.add(*callee->getFunctionType());
+    }
+  }
+
+  return hasher.get();
+}
+
+bool IOCache::isModuleIndependent(const llvm::Function &Func,
+                                  llvm::StringRef IOAttr) {
+  for (const auto &bb : Func)
+    for (const auto &inst : bb) {
+      const auto *call = llvm::dyn_cast<llvm::CallBase>(&inst);
+      if (!call)
+        continue;
+
+      if (call->isIndirectCall())
+        return false;
+
+      const auto *callee = llvm::dyn_cast<llvm::Function>(
+          call->getCalledOperand()->stripPointerCasts());
+      if (callee && callee->isDeclaration() && callee->hasFnAttribute(IOAttr))
+        return false;
+    }
+
+  return true;
+}
+
+bool IOCache::load() {
+#if LLVM_VERSION_MAJOR >= 13
+  // the file size parameter was replaced by a text mode flag in LLVM 13
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(getFilename(), false, false);
+#else
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(getFilename(), -1, false);
+#endif
+
+  if (!bufferOrErr)
+    return false;
+
+  auto &buffer = *bufferOrErr;
+  const auto size = buffer->getBufferSize();
+
+  if (size < sizeof(Header))
+    return false;
+
+  Header header;
+  std::memcpy(&header, buffer->getBufferStart(), sizeof(Header));
+
+  if (std::memcmp(header.Magic, CacheMagic, sizeof(CacheMagic)) ||
+      header.Version != CacheFormatVersion ||
+      size != sizeof(Header) + header.NumRecords * sizeof(Record))
+    return false;
+
+  m_Buffer = std::move(buffer);
+
+  return true;
+}
+
+bool IOCache::lookup(uint64_t Key, unsigned &Categories) const {
+  const auto found = m_NewRecords.find(Key);
+  if (found != m_NewRecords.end()) {
+    Categories = found->second;
+
+    return true;
+  }
+
+  const auto *rec =
+      std::lower_bound(records_begin(), records_end(), Key,
+                       [](const Record &R, uint64_t K) { return R.Key < K; });
+
+  if (rec == records_end() || rec->Key != Key)
+    return false;
+
+  Categories = rec->Value;
+
+  return true;
+}
+
+void IOCache::insert(uint64_t Key, unsigned Categories) {
+  m_NewRecords[Key] = Categories;
+
+  return;
+}
+
+bool IOCache::store() {
+  if (m_NewRecords.empty())
+    return true;
+
+  // merge the sorted on-disk records with the sorted new ones
+  std::vector<Record> merged;
+  merged.reserve((records_end() - records_begin()) + m_NewRecords.size());
+
+  auto ri = records_begin();
+  for (const auto &e : m_NewRecords) {
+    for (; ri != records_end() && ri->Key < e.first; ++ri)
+      merged.push_back(*ri);
+
+    if (ri != records_end() && ri->Key == e.first)
+      ++ri;
+
+    merged.push_back({e.first, e.second});
+  }
+
+  merged.insert(merged.end(), ri, records_end());
+
+  // write to a unique file and rename it over the store, so that concurrent
+  // compiler invocations never observe a partially written store
+  llvm::SmallString<128> tmpPath(m_Dir);
+  llvm::sys::path::append(tmpPath, "aioattr-%%%%%%%%.tmp");
+
+  int fd;
+  if (llvm::sys::fs::createUniqueFile(tmpPath, fd, tmpPath))
+    return false;
+
+  {
+    llvm::raw_fd_ostream os(fd, true);
+    Header header;
+
+    std::memcpy(header.Magic, CacheMagic, sizeof(CacheMagic));
+    header.Version = CacheFormatVersion;
+    header.NumRecords = merged.size();
+
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char *>(merged.data()),
+             merged.size() * sizeof(Record));
+
+    if (os.has_error()) {
+      os.clear_error();
+      llvm::sys::fs::remove(tmpPath);
+
+      return false;
+    }
+  }
+
+  return !llvm::sys::fs::rename(tmpPath, getFilename());
+}
+
+//
+// private methods
+//
+
+const IOCache::Record *IOCache::records_begin() const {
+  if (!m_Buffer)
+    return nullptr;
+
+  return reinterpret_cast<const Record *>(m_Buffer->getBufferStart() +
+                                          sizeof(Header));
+}
+
+const IOCache::Record *IOCache::records_end() const {
+  if (!m_Buffer)
+    return nullptr;
+
+  return reinterpret_cast<const Record *>(m_Buffer->getBufferEnd());
+}
+
+std::string IOCache::getFilename() const {
+  llvm::SmallString<128> path(m_Dir);
+  llvm::sys::path::append(path, CacheFilename);
+
+  return path.str().str();
+}
+
+} // namespace icsa end
@@ -0,0 +1,74 @@
+//
+//
+//
+
+#include "llvm/ADT/STLExtras.h"
+// using llvm::array_lengthof
+
+#include <cstdint>
+// using uint32_t
+
+#include "IOCatalog.hpp"
+
+namespace icsa {
+
+namespace {
+
+struct IONameEntry {
+  const char *Name;
+  unsigned Categories;
+};
+
+// the categories of all library functions as an array indexed by LibFunc
+// that is filled in at compile time
+struct LibFuncCatalog {
+  unsigned Categories[llvm::NumLibFuncs];
+
+  constexpr LibFuncCatalog() : Categories{} {
+#define GET_IO_LIBFUNC_CATALOG
+#define IO_LIBFUNC(F, C) Categories[llvm::LibFunc_##F] = C;
+#include "IOCatalog.inc"
+#undef IO_LIBFUNC
+#undef GET_IO_LIBFUNC_CATALOG
+  }
+};
+
+constexpr LibFuncCatalog LibFuncIOCategories;
+
+#define GET_IO_NAME_CATALOG
+#include "IOCatalog.inc"
+#undef GET_IO_NAME_CATALOG
+
+// must be kept in sync with fnv1a() in utils/scripts/gen_io_catalog.py
+uint32_t hashIOName(llvm::StringRef Name, uint32_t Seed) {
+  uint32_t hash = 2166136261u ^ Seed;
+
+  for (const auto c : Name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+} // namespace anonymous end
+
+#define GET_IO_CATALOG_VERSION
+#include "IOCatalog.inc"
+#undef GET_IO_CATALOG_VERSION
+
+unsigned getLibFuncIOCategories(llvm::LibFunc F) {
+  return LibFuncIOCategories.Categories[F];
+}
+
+unsigned getNamedIOCategories(llvm::StringRef Name) {
+  const auto bucket =
+      hashIOName(Name, 0) & (llvm::array_lengthof(IONameBucketSeeds) - 1);
+  const auto slot = hashIOName(Name, IONameBucketSeeds[bucket]) &
+                    (llvm::array_lengthof(IONameTable) - 1);
+  const auto &entry = IONameTable[slot];
+
+  return entry.Name && Name == entry.Name ? entry.Categories : IOC_NONE;
+}
+
+} // namespace icsa end
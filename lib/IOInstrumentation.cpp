@@ -0,0 +1,154 @@
+//
+//
+//
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/Instructions.h"
+// using llvm::CallInst
+// using llvm::InvokeInst
+
+#include "llvm/IR/IRBuilder.h"
+// using llvm::IRBuilder
+
+#include "llvm/IR/GlobalVariable.h"
+// using llvm::GlobalVariable
+
+#include "llvm/IR/Constants.h"
+// using llvm::ConstantArray
+// using llvm::ConstantInt
+
+#include "llvm/IR/DerivedTypes.h"
+// using llvm::ArrayType
+// using llvm::FunctionType
+
+#include "llvm/Transforms/Utils/ModuleUtils.h"
+// using llvm::appendToGlobalCtors
+
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+// using llvm::SplitCriticalEdge
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/Support/Casting.h"
+// using llvm::dyn_cast
+// using llvm::cast
+
+#include "IOInstrumentation.hpp"
+
+// the probes are implemented in runtime/AIOAttrRuntime.cpp:
+// uint64_t __aioattr_probe_begin(void)
+// void __aioattr_probe_end(uint32_t Site, uint64_t Start)
+// uint32_t __aioattr_register_sites(const char *Module, uint32_t NumSites,
+//                                   const char *const *Names)
+// and must be kept in sync
+
+namespace icsa {
+
+namespace {
+
+// the probes that run before the registration of their module, e.g. in the
+// constructors of other modules, are dropped by the runtime
+const uint32_t UnregisteredSiteBase = 0x80000000u;
+
+} // namespace anonymous end
+
+bool IOInstrumentation::instrument(llvm::Instruction &Site,
+                                   llvm::StringRef Name) {
+  llvm::Instruction *end = nullptr;
+
+  if (auto *call = llvm::dyn_cast<llvm::CallInst>(&Site)) {
+    if (call->isMustTailCall())
+      return false;
+
+    end = call->getNextNode();
+  } else if (auto *invoke = llvm::dyn_cast<llvm::InvokeInst>(&Site)) {
+    // the end probe goes to the start of the normal destination, on an edge
+    // of its own
+    auto *normalDest = invoke->getNormalDest();
+
+    if (normalDest->getSinglePredecessor() != invoke->getParent())
+      normalDest = llvm::SplitCriticalEdge(invoke, 0);
+
+    if (!normalDest)
+      return false;
+
+    end = &*normalDest->getFirstInsertionPt();
+  } else
+    return false;
+
+  auto &ctx = m_Module.getContext();
+  auto *int32Ty = llvm::Type::getInt32Ty(ctx);
+  auto *int64Ty = llvm::Type::getInt64Ty(ctx);
+
+  if (!m_SiteBase)
+    m_SiteBase = new llvm::GlobalVariable(
+        m_Module, int32Ty, false, llvm::GlobalValue::InternalLinkage,
+        llvm::ConstantInt::get(int32Ty, UnregisteredSiteBase),
+        "aioattr.site_base");
+
+  auto probeBegin =
+      m_Module.getOrInsertFunction("__aioattr_probe_begin", int64Ty);
+  auto probeEnd = m_Module.getOrInsertFunction(
+      "__aioattr_probe_end", llvm::Type::getVoidTy(ctx), int32Ty, int64Ty);
+
+  llvm::IRBuilder<> builder(&Site);
+  auto *start = builder.CreateCall(probeBegin, {});
+
+  builder.SetInsertPoint(end);
+  auto *site = builder.CreateAdd(
+      builder.CreateLoad(int32Ty, m_SiteBase),
+      llvm::ConstantInt::get(int32Ty, m_SiteNames.size()));
+  builder.CreateCall(probeEnd, {site, start});
+
+  m_SiteNames.push_back(Name.str());
+
+  return true;
+}
+
+bool IOInstrumentation::finalize() {
+  if (m_SiteNames.empty())
+    return false;
+
+  auto &ctx = m_Module.getContext();
+  auto *int32Ty = llvm::Type::getInt32Ty(ctx);
+  auto *int8PtrTy = llvm::Type::getInt8PtrTy(ctx);
+
+  auto *ctor = llvm::Function::Create(
+      llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), false),
+      llvm::GlobalValue::InternalLinkage, "aioattr.module_ctor", &m_Module);
+  llvm::IRBuilder<> builder(llvm::BasicBlock::Create(ctx, "entry", ctor));
+
+  llvm::SmallVector<llvm::Constant *, 16> names;
+  for (const auto &name : m_SiteNames)
+    names.push_back(
+        llvm::cast<llvm::Constant>(builder.CreateGlobalStringPtr(name)));
+
+  auto *namesTy = llvm::ArrayType::get(int8PtrTy, names.size());
+  auto *namesTable = new llvm::GlobalVariable(
+      m_Module, namesTy, true, llvm::GlobalValue::PrivateLinkage,
+      llvm::ConstantArray::get(namesTy, names), "aioattr.site_names");
+
+  auto registerSites = m_Module.getOrInsertFunction(
+      "__aioattr_register_sites", int32Ty, int8PtrTy, int32Ty,
+      int8PtrTy->getPointerTo());
+
+  auto *base = builder.CreateCall(
+      registerSites,
+      {builder.CreateGlobalStringPtr(m_Module.getModuleIdentifier()),
+       llvm::ConstantInt::get(int32Ty, names.size()),
+       builder.CreateConstInBoundsGEP2_32(namesTy, namesTable, 0, 0)});
+  builder.CreateStore(base, m_SiteBase);
+  builder.CreateRetVoid();
+
+  llvm::appendToGlobalCtors(m_Module, ctor, 0);
+
+  return true;
+}
+
+} // namespace icsa end
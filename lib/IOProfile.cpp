@@ -0,0 +1,111 @@
+//
+//
+//
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
+#include "llvm/Support/MemoryBuffer.h"
+// using llvm::MemoryBuffer
+
+#include <cstring>
+// using std::memcmp
+// using std::memcpy
+
+#include "IOProfile.hpp"
+
+// the format is described in runtime/AIOAttrRuntime.cpp and must be kept in
+// sync
+
+namespace icsa {
+
+namespace {
+
+const char ProfileMagic[8] = {'A', 'I', 'O', 'P', 'R', 'O', 'F', '\0'};
+const uint32_t ProfileVersion = 1;
+
+class ProfileCursor {
+public:
+  ProfileCursor(const char *Begin, const char *End)
+      : m_Cur{Begin}, m_End{End} {}
+
+  template <typename T> bool read(T &Value) {
+    if (static_cast<std::size_t>(m_End - m_Cur) < sizeof(T))
+      return false;
+
+    std::memcpy(&Value, m_Cur, sizeof(T));
+    m_Cur += sizeof(T);
+
+    return true;
+  }
+
+  bool read(std::string &Str) {
+    uint32_t size;
+    if (!read(size) || static_cast<std::size_t>(m_End - m_Cur) < size)
+      return false;
+
+    Str.assign(m_Cur, size);
+    m_Cur += size;
+
+    return true;
+  }
+
+private:
+  const char *m_Cur;
+  const char *m_End;
+};
+
+} // namespace anonymous end
+
+bool IOProfile::read(llvm::StringRef Filename) {
+#if LLVM_VERSION_MAJOR >= 13
+  // the file size parameter was replaced by a text mode flag in LLVM 13
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(Filename, false, false);
+#else
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(Filename, -1, false);
+#endif
+  if (!bufferOrErr)
+    return false;
+
+  const auto &buffer = **bufferOrErr;
+  ProfileCursor cursor(buffer.getBufferStart(), buffer.getBufferEnd());
+
+  char magic[sizeof(ProfileMagic)];
+  uint32_t version;
+  uint32_t numSites;
+
+  if (!cursor.read(magic) ||
+      std::memcmp(magic, ProfileMagic, sizeof(ProfileMagic)) ||
+      !cursor.read(version) || version != ProfileVersion ||
+      !cursor.read(numSites))
+    return false;
+
+  // the sites are merged only once the whole profile is read, so that a
+  // truncated profile leaves the merged ones unchanged
+  std::vector<Site> sites(numSites);
+
+  for (auto &site : sites)
+    if (!cursor.read(site.Calls) || !cursor.read(site.Nanoseconds) ||
+        !cursor.read(site.Module) || !cursor.read(site.Name))
+      return false;
+
+  for (auto &site : sites) {
+    const auto key = std::make_pair(site.Module, site.Name);
+    const auto found = m_Index.find(key);
+
+    if (found == m_Index.end()) {
+      m_Index.emplace(key, m_Sites.size());
+      m_Sites.push_back(std::move(site));
+
+      continue;
+    }
+
+    auto &merged = m_Sites[found->second];
+    merged.Calls += site.Calls;
+    merged.Nanoseconds += site.Nanoseconds;
+  }
+
+  return true;
+}
+
+} // namespace icsa end
@@ -0,0 +1,155 @@
+//
+//
+//
+
+#include "llvm/Support/MemoryBuffer.h"
+// using llvm::MemoryBuffer
+
+#include "llvm/Support/LineIterator.h"
+// using llvm::line_iterator
+
+#include "llvm/Support/FileSystem.h"
+// using llvm::sys::fs::OpenFlags
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::raw_fd_ostream
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include <system_error>
+// using std::error_code
+
+#include <utility>
+// using std::move
+
+#include "IOSummary.hpp"
+
+// the summary file holds one line per function:
+// <guid> <has io: 0|1> [<callee guid> ...]
+// while the facts file holds one guid per line
+
+namespace icsa {
+
+void IOSummary::add(uint64_t GUID, bool HasIO, std::vector<uint64_t> Callees) {
+  auto &entry = m_Entries[GUID];
+
+  // the same linkonce function may be summarized by several modules
+  entry.HasIO |= HasIO;
+  entry.Callees.insert(entry.Callees.end(), Callees.begin(), Callees.end());
+
+  return;
+}
+
+bool IOSummary::read(llvm::StringRef Filename) {
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(Filename);
+  if (!bufferOrErr)
+    return false;
+
+  for (llvm::line_iterator li(**bufferOrErr), le; li != le; ++li) {
+    llvm::SmallVector<llvm::StringRef, 8> fields;
+    li->split(fields, ' ', -1, false);
+
+    uint64_t guid;
+    unsigned hasIO;
+    if (fields.size() < 2 || fields[0].getAsInteger(10, guid) ||
+        fields[1].getAsInteger(10, hasIO))
+      return false;
+
+    std::vector<uint64_t> callees;
+    for (unsigned i = 2; i < fields.size(); ++i) {
+      uint64_t callee;
+      if (fields[i].getAsInteger(10, callee))
+        return false;
+
+      callees.push_back(callee);
+    }
+
+    add(guid, hasIO, std::move(callees));
+  }
+
+  return true;
+}
+
+bool IOSummary::write(llvm::StringRef Filename) const {
+  std::error_code err;
+  llvm::raw_fd_ostream os(Filename, err, llvm::sys::fs::OF_Text);
+
+  if (err)
+    return false;
+
+  for (const auto &e : m_Entries) {
+    os << e.first << " " << e.second.HasIO;
+
+    for (const auto &callee : e.second.Callees)
+      os << " " << callee;
+
+    os << "\n";
+  }
+
+  return true;
+}
+
+std::set<uint64_t> IOSummary::resolve() const {
+  std::map<uint64_t, std::vector<uint64_t>> callers;
+  std::vector<uint64_t> workList;
+  std::set<uint64_t> facts;
+
+  for (const auto &e : m_Entries) {
+    for (const auto &callee : e.second.Callees)
+      callers[callee].push_back(e.first);
+
+    if (e.second.HasIO && facts.insert(e.first).second)
+      workList.push_back(e.first);
+  }
+
+  // IO flows from callees to callers; each function enters the worklist at
+  // most once
+  while (!workList.empty()) {
+    const auto guid = workList.back();
+    workList.pop_back();
+
+    const auto found = callers.find(guid);
+    if (found == callers.end())
+      continue;
+
+    for (const auto &caller : found->second)
+      if (facts.insert(caller).second)
+        workList.push_back(caller);
+  }
+
+  return facts;
+}
+
+bool IOSummary::readFacts(llvm::StringRef Filename,
+                          std::set<uint64_t> &Facts) {
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(Filename);
+  if (!bufferOrErr)
+    return false;
+
+  for (llvm::line_iterator li(**bufferOrErr), le; li != le; ++li) {
+    uint64_t guid;
+    if (li->trim().getAsInteger(10, guid))
+      return false;
+
+    Facts.insert(guid);
+  }
+
+  return true;
+}
+
+bool IOSummary::writeFacts(llvm::StringRef Filename,
+                           const std::set<uint64_t> &Facts) {
+  std::error_code err;
+  llvm::raw_fd_ostream os(Filename, err, llvm::sys::fs::OF_Text);
+
+  if (err)
+    return false;
+
+  for (const auto &guid : Facts)
+    os << guid << "\n";
+
+  return true;
+}
+
+} // namespace icsa end
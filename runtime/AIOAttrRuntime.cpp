@@ -0,0 +1,210 @@
+//
+//
+//
+
+// runtime support of the -aioattr-instrument mode; the probes count and time
+// the calls of each IO call site in per-thread buffers, which are merged when
+// their thread exits, and the merged profile is written at process exit to
+// the file named by AIOATTR_PROFILE (default: aioattr.prof)
+//
+// the profile is stored in native byte order:
+//   char     magic[8] = "AIOPROF"
+//   uint32_t version
+//   uint32_t number of sites
+// followed by one record per site:
+//   uint64_t calls
+//   uint64_t nanoseconds
+//   uint32_t module name length, module name
+//   uint32_t site name length, site name
+//
+// the format must be kept in sync with lib/IOProfile.cpp
+
+#include <mutex>
+// using std::mutex
+// using std::lock_guard
+
+#include <vector>
+// using std::vector
+
+#include <string>
+// using std::string
+
+#include <cstdio>
+// using std::fopen
+// using std::fwrite
+
+#include <cstdlib>
+// using std::getenv
+// using std::atexit
+
+#include <cstdint>
+// using uint32_t
+// using uint64_t
+
+#include <time.h>
+// using clock_gettime
+
+namespace {
+
+const char ProfileMagic[8] = {'A', 'I', 'O', 'P', 'R', 'O', 'F', '\0'};
+const uint32_t ProfileVersion = 1;
+
+// must be kept in sync with lib/IOInstrumentation.cpp
+const uint32_t UnregisteredSiteBase = 0x80000000u;
+
+struct SiteCounters {
+  uint64_t Calls = 0;
+  uint64_t Nanoseconds = 0;
+};
+
+void accumulate(std::vector<SiteCounters> &Counters, uint32_t Site,
+                uint64_t Calls, uint64_t Nanoseconds) {
+  if (Site >= Counters.size())
+    Counters.resize(Site + 1);
+
+  Counters[Site].Calls += Calls;
+  Counters[Site].Nanoseconds += Nanoseconds;
+
+  return;
+}
+
+void writeString(std::FILE *File, const std::string &Str) {
+  const uint32_t size = Str.size();
+
+  std::fwrite(&size, sizeof(size), 1, File);
+  std::fwrite(Str.data(), 1, size, File);
+
+  return;
+}
+
+class Profile {
+public:
+  uint32_t registerSites(const char *Module, uint32_t NumSites,
+                         const char *const *Names) {
+    std::lock_guard<std::mutex> guard(m_Lock);
+    const uint32_t base = m_Names.size();
+
+    for (uint32_t i = 0; i < NumSites; ++i) {
+      m_Modules.push_back(Module);
+      m_Names.push_back(Names[i]);
+    }
+
+    return base;
+  }
+
+  void merge(const std::vector<SiteCounters> &Counters) {
+    std::lock_guard<std::mutex> guard(m_Lock);
+
+    for (uint32_t i = 0; i < Counters.size(); ++i)
+      if (Counters[i].Calls)
+        accumulate(m_Counters, i, Counters[i].Calls, Counters[i].Nanoseconds);
+
+    return;
+  }
+
+  void record(uint32_t Site, uint64_t Nanoseconds) {
+    std::lock_guard<std::mutex> guard(m_Lock);
+    accumulate(m_Counters, Site, 1, Nanoseconds);
+
+    return;
+  }
+
+  void write() {
+    std::lock_guard<std::mutex> guard(m_Lock);
+    const char *filename = std::getenv("AIOATTR_PROFILE");
+    auto *file = std::fopen(filename ? filename : "aioattr.prof", "wb");
+    if (!file)
+      return;
+
+    const uint32_t numSites = m_Names.size();
+    m_Counters.resize(numSites);
+
+    std::fwrite(ProfileMagic, sizeof(ProfileMagic), 1, file);
+    std::fwrite(&ProfileVersion, sizeof(ProfileVersion), 1, file);
+    std::fwrite(&numSites, sizeof(numSites), 1, file);
+
+    for (uint32_t i = 0; i < numSites; ++i) {
+      std::fwrite(&m_Counters[i].Calls, sizeof(uint64_t), 1, file);
+      std::fwrite(&m_Counters[i].Nanoseconds, sizeof(uint64_t), 1, file);
+      writeString(file, m_Modules[i]);
+      writeString(file, m_Names[i]);
+    }
+
+    std::fclose(file);
+
+    return;
+  }
+
+private:
+  std::mutex m_Lock;
+  std::vector<std::string> m_Modules;
+  std::vector<std::string> m_Names;
+  std::vector<SiteCounters> m_Counters;
+};
+
+// the profile is never destroyed, since the probes of the static destructors
+// may run at any point of the exit; it is written by an exit handler that the
+// first registration installs, which runs after the thread-local buffers of
+// the main thread are merged, and the later probes are not written
+Profile &getProfile() {
+  static Profile *profile = [] {
+    auto *p = new Profile;
+    std::atexit([] { getProfile().write(); });
+
+    return p;
+  }();
+
+  return *profile;
+}
+
+// probes may run after the buffer of their thread is gone, e.g. in static
+// destructors, and then record into the profile directly
+thread_local bool BufferDestroyed;
+
+struct ThreadBuffer {
+  ~ThreadBuffer() {
+    getProfile().merge(Counters);
+    BufferDestroyed = true;
+  }
+
+  std::vector<SiteCounters> Counters;
+};
+
+thread_local ThreadBuffer Buffer;
+
+uint64_t now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+}
+
+} // namespace anonymous end
+
+extern "C" {
+
+uint32_t __aioattr_register_sites(const char *Module, uint32_t NumSites,
+                                  const char *const *Names) {
+  return getProfile().registerSites(Module, NumSites, Names);
+}
+
+uint64_t __aioattr_probe_begin() { return now(); }
+
+void __aioattr_probe_end(uint32_t Site, uint64_t Start) {
+  const auto elapsed = now() - Start;
+
+  if (Site >= UnregisteredSiteBase)
+    return;
+
+  if (BufferDestroyed) {
+    getProfile().record(Site, elapsed);
+
+    return;
+  }
+
+  accumulate(Buffer.Counters, Site, 1, elapsed);
+
+  return;
+}
+
+} // extern "C" end
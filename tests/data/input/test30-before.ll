@@ -0,0 +1,8 @@
+define linkonce_odr void @edited() {
+  ret void
+}
+
+define linkonce_odr i32 @unchanged(i32 %a) {
+  %1 = mul i32 %a, %a
+  ret i32 %1
+}
@@ -0,0 +1,205 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -S < %s > %t.serial
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-threads=4 -S < %s > %t.parallel
+; RUN: diff %t.serial %t.parallel
+; RUN: FileCheck %s < %t.parallel
+
+; the functions are spread over the worker threads, which must give the same
+; verdicts as the serial run
+
+@.str = private unnamed_addr constant [13 x i8] c"hello world!\00", align 1
+
+; CHECK: define void @io0() [[IO:#[0-9]+]]
+define void @io0() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio0(i32 %a) {
+define i32 @noio0(i32 %a) {
+  %1 = mul i32 %a, %a
+  ret i32 %1
+}
+
+; CHECK: define void @io1() [[IO]]
+define void @io1() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio1(i32 %a) {
+define i32 @noio1(i32 %a) {
+  %1 = call i32 @noio0(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io2() [[IO]]
+define void @io2() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio2(i32 %a) {
+define i32 @noio2(i32 %a) {
+  %1 = call i32 @noio1(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io3() [[IO]]
+define void @io3() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio3(i32 %a) {
+define i32 @noio3(i32 %a) {
+  %1 = call i32 @noio2(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io4() [[IO]]
+define void @io4() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio4(i32 %a) {
+define i32 @noio4(i32 %a) {
+  %1 = call i32 @noio3(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io5() [[IO]]
+define void @io5() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio5(i32 %a) {
+define i32 @noio5(i32 %a) {
+  %1 = call i32 @noio4(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io6() [[IO]]
+define void @io6() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio6(i32 %a) {
+define i32 @noio6(i32 %a) {
+  %1 = call i32 @noio5(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io7() [[IO]]
+define void @io7() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio7(i32 %a) {
+define i32 @noio7(i32 %a) {
+  %1 = call i32 @noio6(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io8() [[IO]]
+define void @io8() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio8(i32 %a) {
+define i32 @noio8(i32 %a) {
+  %1 = call i32 @noio7(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io9() [[IO]]
+define void @io9() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio9(i32 %a) {
+define i32 @noio9(i32 %a) {
+  %1 = call i32 @noio8(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io10() [[IO]]
+define void @io10() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio10(i32 %a) {
+define i32 @noio10(i32 %a) {
+  %1 = call i32 @noio9(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io11() [[IO]]
+define void @io11() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio11(i32 %a) {
+define i32 @noio11(i32 %a) {
+  %1 = call i32 @noio10(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io12() [[IO]]
+define void @io12() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio12(i32 %a) {
+define i32 @noio12(i32 %a) {
+  %1 = call i32 @noio11(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io13() [[IO]]
+define void @io13() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio13(i32 %a) {
+define i32 @noio13(i32 %a) {
+  %1 = call i32 @noio12(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io14() [[IO]]
+define void @io14() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio14(i32 %a) {
+define i32 @noio14(i32 %a) {
+  %1 = call i32 @noio13(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io15() [[IO]]
+define void @io15() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @noio15(i32 %a) {
+define i32 @noio15(i32 %a) {
+  %1 = call i32 @noio14(i32 %a)
+  ret i32 %1
+}
+
+declare i32 @puts(i8*)
+
+; CHECK: attributes [[IO]] = {{.*}}"icsa-io"
@@ -0,0 +1,37 @@
+; RUN: opt -load-pass-plugin %bindir/%testeelib -passes='apply-io-attribute,function(instcombine),apply-io-attribute' -S < %s | FileCheck %s
+; RUN: opt -load-pass-plugin %bindir/%testeelib -passes='apply-io-attribute,function(instcombine),apply-io-attribute' -debug-pass-manager -disable-output < %s 2>&1 | FileCheck --check-prefix=PM %s
+
+; the verdicts of the functions changed by instcombine are recomputed by the
+; second run, while those of the unchanged functions are reused
+
+; PM: Running pass: icsa::ApplyIOAttributeTransform
+; PM: Running analysis: icsa::ApplyIOAttributeAnalysis on test3
+; PM: Invalidating analysis: icsa::ApplyIOAttributeAnalysis on test2
+; PM-NOT: Invalidating analysis: icsa::ApplyIOAttributeAnalysis on test3
+; PM: Running pass: icsa::ApplyIOAttributeTransform
+; PM-NOT: Running analysis: icsa::ApplyIOAttributeAnalysis on test3
+; PM: Running analysis: icsa::ApplyIOAttributeAnalysis on test2
+; PM-NOT: Running analysis: icsa::ApplyIOAttributeAnalysis on test3
+
+@.str = private unnamed_addr constant [13 x i8] c"hello world!\00", align 1
+
+; CHECK: define void @test1() [[IO:#[0-9]+]]
+define void @test1() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @test2(i32 %a) {
+define i32 @test2(i32 %a) {
+  %1 = mul i32 %a, 1
+  ret i32 %1
+}
+
+; CHECK: define i32 @test3(i32 %a) {
+define i32 @test3(i32 %a) {
+  ret i32 %a
+}
+
+declare i32 @puts(i8*)
+
+; CHECK: attributes [[IO]] = {{.*}}"icsa-io"
@@ -0,0 +1,51 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-loop-attribute -S < %s | FileCheck %s
+
+
+@.str = private unnamed_addr constant [4 x i8] c"%d\0A\00", align 1
+
+define void @test(i32 %n) {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %outer.latch ]
+  br label %inner
+
+; CHECK-LABEL: inner:
+; CHECK: br i1 %{{.*}}, label %inner, label %outer.latch, !llvm.loop ![[INNER:[0-9]+]]
+inner:
+  %j = phi i32 [ 0, %outer ], [ %j.next, %inner ]
+  %call = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([4 x i8], [4 x i8]* @.str, i32 0, i32 0), i32 %j)
+  %j.next = add nsw i32 %j, 1
+  %inner.cmp = icmp slt i32 %j.next, %n
+  br i1 %inner.cmp, label %inner, label %outer.latch
+
+; CHECK-LABEL: outer.latch:
+; CHECK: br i1 %{{.*}}, label %outer, label %loop2.preheader, !llvm.loop ![[OUTER:[0-9]+]]
+outer.latch:
+  %i.next = add nsw i32 %i, 1
+  %outer.cmp = icmp slt i32 %i.next, %n
+  br i1 %outer.cmp, label %outer, label %loop2.preheader
+
+loop2.preheader:
+  br label %loop2
+
+; CHECK-LABEL: loop2:
+; CHECK: br i1 %{{.*}}, label %loop2, label %exit, !llvm.loop ![[LOOP2:[0-9]+]]
+loop2:
+  %k = phi i32 [ 0, %loop2.preheader ], [ %k.next, %loop2 ]
+  %k.next = add nsw i32 %k, 1
+  %loop2.cmp = icmp slt i32 %k.next, %n
+  br i1 %loop2.cmp, label %loop2, label %exit
+
+exit:
+  ret void
+}
+
+declare i32 @printf(i8*, ...)
+
+; CHECK-DAG: ![[OUTER]] = distinct !{![[OUTER]], ![[IO:[0-9]+]]}
+; CHECK-DAG: ![[IO]] = !{!"icsa.io"}
+; CHECK-DAG: ![[INNER]] = distinct !{![[INNER]], ![[IO]]}
+; CHECK-DAG: ![[LOOP2]] = distinct !{![[LOOP2]], ![[NOIO:[0-9]+]]}
+; CHECK-DAG: ![[NOIO]] = !{!"icsa.noio"}
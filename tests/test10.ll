@@ -0,0 +1,57 @@
+; RUN: rm -rf %t && mkdir -p %t
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-cache-dir=%t -aioattr-stats=%t/first.json -aioattr-report-format=json -S < %s | FileCheck %s
+; RUN: test -f %t/aioattr.cache
+; RUN: FileCheck --check-prefix=FIRST %s < %t/first.json
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-cache-dir=%t -aioattr-stats=%t/second.json -aioattr-report-format=json -S < %s | FileCheck %s
+; RUN: FileCheck --check-prefix=SECOND %s < %t/second.json
+
+; only the ODR functions whose verdict does not depend on the rest of the
+; module are stored, and the second run takes their verdicts from the cache
+
+; FIRST-NOT: "source": "cache"
+
+; SECOND-DAG: {"name": "odr_io", {{.*}}"source": "cache"
+; SECOND-DAG: {"name": "odr_noio", {{.*}}"source": "cache"
+; SECOND-DAG: {"name": "odr_indirect", {{.*}}"source": "scan"
+; SECOND-DAG: {"name": "odr_imported", {{.*}}"source": "scan"
+; SECOND-DAG: {"name": "external_io", {{.*}}"source": "scan"
+
+@.str = private unnamed_addr constant [13 x i8] c"hello world!\00", align 1
+
+; CHECK: define linkonce_odr void @odr_io() [[IO:#[0-9]+]]
+define linkonce_odr void @odr_io() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define linkonce_odr i32 @odr_noio(i32 %a) {
+define linkonce_odr i32 @odr_noio(i32 %a) {
+  %1 = mul i32 %a, %a
+  ret i32 %1
+}
+
+; CHECK: define linkonce_odr void @odr_indirect(void ()* %f) {
+define linkonce_odr void @odr_indirect(void ()* %f) {
+  call void %f()
+  ret void
+}
+
+; CHECK: define linkonce_odr void @odr_imported() [[IO]]
+define linkonce_odr void @odr_imported() {
+  call void @imported()
+  ret void
+}
+
+; CHECK: define void @external_io() [[IO]]
+define void @external_io() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+declare i32 @puts(i8*)
+
+declare void @imported() #0
+
+attributes #0 = { "icsa-io"="1" }
+
+; CHECK: attributes [[IO]] = {{.*}}"icsa-io"
@@ -0,0 +1,41 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-thinlto-summary=%t.1.sum -disable-output < %s
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-thinlto-summary=%t.2.sum -disable-output < %inputdatadir/test11-module2.ll
+; RUN: %toolsdir/aioattr-thinlink/aioattr-thinlink %t.1.sum %t.2.sum -o %t.facts
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-thinlto-facts=%t.facts -S < %s | FileCheck %s
+
+; the facts add all categories only to the functions whose body shows no IO,
+; while the local categories of the others are kept
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+
+; CHECK: define void @test1(i8* %msg) #[[ALL:[0-9]+]]
+define void @test1(i8* %msg) {
+  call void @report(i8* %msg)
+  ret void
+}
+
+; CHECK: define i32 @test2(i32 %a) {
+define i32 @test2(i32 %a) {
+  %1 = add i32 %a, 1
+  ret i32 %1
+}
+
+; CHECK: define void @console() #[[CONSOLE:[0-9]+]]
+define void @console() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @via_local() #[[ALL]]
+define void @via_local() {
+  call void @console()
+  ret void
+}
+
+; CHECK: declare void @report(i8*) #[[ALL]]
+declare void @report(i8*)
+
+declare i32 @puts(i8*)
+
+; CHECK-DAG: attributes #[[ALL]] = { "icsa-io"="63" }
+; CHECK-DAG: attributes #[[CONSOLE]] = { "icsa-io"="1" }
@@ -0,0 +1,28 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-stats=%t -aioattr-report-format=json -disable-output < %s
+; RUN: FileCheck %s < %t
+
+
+%struct._IO_FILE = type { i32, i8*, i8*, i8*, i8*, i8*, i8*, i8*, i8*, i8*, i8*, i8*, %struct._IO_marker*, %struct._IO_FILE*, i32, i32, i64, i16, i8, [1 x i8], i8*, i64, i8*, i8*, i8*, i8*, i64, i32, [20 x i8] }
+%struct._IO_marker = type { %struct._IO_marker*, %struct._IO_FILE*, i32 }
+
+@stderr = external global %struct._IO_FILE*, align 8
+@.str = private unnamed_addr constant [4 x i8] c"%s\0A\00", align 1
+@.str.1 = private unnamed_addr constant [13 x i8] c"hello world!\00", align 1
+
+; CHECK: "functions_processed": 2,
+; CHECK-NEXT: "attribute_applications": 1,
+
+; CHECK: {"name": "test1", "instructions": 3, "time_ns": {{[0-9]+}}, "io": true, "source": "scan", "callee": "fprintf", "category": "libc", "categories": ["file write"]}
+define void @test1() {
+  %1 = load %struct._IO_FILE*, %struct._IO_FILE** @stderr, align 8
+  %2 = call i32 (%struct._IO_FILE*, i8*, ...) @fprintf(%struct._IO_FILE* %1, i8* getelementptr inbounds ([4 x i8], [4 x i8]* @.str, i32 0, i32 0), i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str.1, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: {"name": "test2", "instructions": 2, "time_ns": {{[0-9]+}}, "io": false, "source": "scan"}
+define i32 @test2(i32 %a) {
+  %1 = mul i32 %a, %a
+  ret i32 %1
+}
+
+declare i32 @fprintf(%struct._IO_FILE*, i8*, ...)
@@ -0,0 +1,43 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -S < %s | FileCheck %s
+
+
+%struct._IO_FILE = type opaque
+%struct.stat = type opaque
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+@.str.1 = private unnamed_addr constant [3 x i8] c"ls\00", align 1
+@.str.2 = private unnamed_addr constant [2 x i8] c"r\00", align 1
+
+; CHECK: define void @test_read(%struct._IO_FILE* %f, i8* %buf, %struct.stat* %st) #[[READ:[0-9]+]]
+define void @test_read(%struct._IO_FILE* %f, i8* %buf, %struct.stat* %st) {
+  %1 = call i64 @fread(i8* %buf, i64 1, i64 16, %struct._IO_FILE* %f)
+  %2 = call i32 @stat(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0), %struct.stat* %st)
+  ret void
+}
+
+; CHECK: define void @test_console() #[[CONSOLE:[0-9]+]]
+define void @test_console() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @test_process() #[[PROCESS:[0-9]+]]
+define void @test_process() {
+  %1 = call %struct._IO_FILE* @popen(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @.str.1, i32 0, i32 0), i8* getelementptr inbounds ([2 x i8], [2 x i8]* @.str.2, i32 0, i32 0))
+  call void @flockfile(%struct._IO_FILE* %1)
+  ret void
+}
+
+declare i64 @fread(i8*, i64, i64, %struct._IO_FILE*)
+
+declare i32 @stat(i8*, %struct.stat*)
+
+declare i32 @puts(i8*)
+
+declare %struct._IO_FILE* @popen(i8*, i8*)
+
+declare void @flockfile(%struct._IO_FILE*)
+
+; CHECK-DAG: attributes #[[READ]] = { "icsa-io"="10" }
+; CHECK-DAG: attributes #[[CONSOLE]] = { "icsa-io"="1" }
+; CHECK-DAG: attributes #[[PROCESS]] = { "icsa-io"="48" }
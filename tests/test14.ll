@@ -0,0 +1,15 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -S < %s | FileCheck %s
+
+
+; CHECK: define void @test(i8* %buf) #[[ATTR:[0-9]+]]
+define void @test(i8* %buf) {
+  %1 = call i32 @socket(i32 2, i32 1, i32 0)
+  %2 = call i64 @send(i32 %1, i8* %buf, i64 16, i32 0)
+  ret void
+}
+
+declare i32 @socket(i32, i32, i32)
+
+declare i64 @send(i32, i8*, i64, i32)
+
+; CHECK: attributes #[[ATTR]] = { "icsa-io"="12" }
@@ -0,0 +1,54 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -S < %s | FileCheck %s
+; RUN: opt -load-pass-plugin %bindir/%testeelib -passes=apply-io-attribute -S < %s | FileCheck %s
+
+
+%"class.std::basic_ostream" = type opaque
+
+@_ZSt4cout = external global %"class.std::basic_ostream", align 8
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+@print = global i32 (i8*)* @puts, align 8
+@compute = global i32 (i32)* @square, align 8
+
+; CHECK: define void @test_invoke() #[[INVOKE:[0-9]+]] personality
+define void @test_invoke() personality i8* bitcast (i32 (...)* @__gxx_personality_v0 to i8*) {
+entry:
+  %call = invoke dereferenceable(272) %"class.std::basic_ostream"* @_ZStlsISt11char_traitsIcEERSt13basic_ostreamIcT_ES5_PKc(%"class.std::basic_ostream"* dereferenceable(272) @_ZSt4cout, i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+          to label %cont unwind label %lpad
+
+cont:
+  ret void
+
+lpad:
+  %0 = landingpad { i8*, i32 }
+          cleanup
+  resume { i8*, i32 } %0
+}
+
+; CHECK: define void @test_indirect() #[[INDIRECT:[0-9]+]]
+define void @test_indirect() {
+  %1 = load i32 (i8*)*, i32 (i8*)** @print, align 8
+  %2 = call i32 %1(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @test_indirect_noio(i32 %a) {
+define i32 @test_indirect_noio(i32 %a) {
+  %1 = load i32 (i32)*, i32 (i32)** @compute, align 8
+  %2 = call i32 %1(i32 %a)
+  ret i32 %2
+}
+
+; CHECK: define i32 @square(i32 %a) {
+define i32 @square(i32 %a) {
+  %1 = mul i32 %a, %a
+  ret i32 %1
+}
+
+declare dereferenceable(272) %"class.std::basic_ostream"* @_ZStlsISt11char_traitsIcEERSt13basic_ostreamIcT_ES5_PKc(%"class.std::basic_ostream"* dereferenceable(272), i8*)
+
+declare i32 @__gxx_personality_v0(...)
+
+declare i32 @puts(i8*)
+
+; CHECK-DAG: attributes #[[INVOKE]] = { "icsa-io"="5" }
+; CHECK-DAG: attributes #[[INDIRECT]] = { "icsa-io"="1" }
@@ -0,0 +1,28 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-ipo -S < %s | FileCheck %s
+
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+@handler = global void ()* @report, align 8
+
+; CHECK: define void @dispatch() #[[ATTR:[0-9]+]]
+define void @dispatch() {
+  %1 = load void ()*, void ()** @handler, align 8
+  call void %1()
+  ret void
+}
+
+; CHECK: define void @run() #[[ATTR]]
+define void @run() {
+  call void @dispatch()
+  ret void
+}
+
+; CHECK: define void @report() #[[ATTR]]
+define void @report() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+declare i32 @puts(i8*)
+
+; CHECK: attributes #[[ATTR]] = { "icsa-io"="1" }
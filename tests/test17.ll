@@ -0,0 +1,32 @@
+; RUN: llvm-as < %s > %t.1.bc
+; RUN: llvm-as < %inputdatadir/test11-module2.ll > %t.2.bc
+; RUN: %toolsdir/aioattr-scan/aioattr-scan -j 2 %t.1.bc %t.2.bc -o %t
+; RUN: FileCheck %s < %t
+; RUN: echo 'test.*' > %t.whitelist
+; RUN: %toolsdir/aioattr-scan/aioattr-scan -fn-whitelist=%t.whitelist %t.1.bc %t.2.bc -o %t.filtered
+; RUN: FileCheck -check-prefix=FILTERED %s < %t.filtered
+
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+
+; CHECK: 4
+; CHECK-NEXT: 2
+; CHECK-NEXT: {{.*}}.1.bc:test1 1
+; CHECK-NEXT: {{.*}}.2.bc:log_line 4
+; CHECK-NOT: report
+
+; FILTERED: 2
+; FILTERED-NEXT: 1
+; FILTERED-NEXT: {{.*}}.1.bc:test1 1
+; FILTERED-NOT: log_line
+define void @test1() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+define i32 @test2(i32 %a) {
+  %1 = mul i32 %a, %a
+  ret i32 %1
+}
+
+declare i32 @puts(i8*)
@@ -0,0 +1,49 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-engine=uselist -S < %s | FileCheck %s
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-engine=verify -disable-output < %s 2>&1 | FileCheck -allow-empty -check-prefix=VERIFY %s
+
+; VERIFY-NOT: engine mismatch
+
+
+%struct._IO_FILE = type opaque
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+
+; CHECK: define void @test_direct(%struct._IO_FILE* %f) #[[DIRECT:[0-9]+]]
+define void @test_direct(%struct._IO_FILE* %f) {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  %2 = call i32 @fputs(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0), %struct._IO_FILE* %f)
+  ret void
+}
+
+; CHECK: define void @test_loop(i32 %n) #[[LOOP:[0-9]+]]
+define void @test_loop(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %0 = call i32 @putchar(i32 %i)
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; CHECK: define i32 @test_noio(i32 %a) {
+define i32 @test_noio(i32 %a) {
+  %1 = call i32 @abs(i32 %a)
+  ret i32 %1
+}
+
+declare i32 @puts(i8*)
+
+declare i32 @fputs(i8*, %struct._IO_FILE*)
+
+declare i32 @putchar(i32)
+
+declare i32 @abs(i32)
+
+; CHECK-DAG: attributes #[[DIRECT]] = { "icsa-io"="5" }
+; CHECK-DAG: attributes #[[LOOP]] = { "icsa-io"="1" }
@@ -0,0 +1,109 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-noio -S < %s | FileCheck %s
+
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+@counter = global i32 0, align 4
+@callback = global i32 (i32)* @leaf, align 8
+
+; CHECK: define i32 @leaf(i32 %a) #[[NOSYNC:[0-9]+]]
+define i32 @leaf(i32 %a) {
+  %1 = mul i32 %a, %a
+  ret i32 %1
+}
+
+; CHECK: define i32 @recursive(i32 %a) #[[NOSYNC]]
+define i32 @recursive(i32 %a) {
+  %1 = icmp eq i32 %a, 0
+  br i1 %1, label %done, label %rec
+
+rec:
+  %2 = sub i32 %a, 1
+  %3 = call i32 @recursive(i32 %2)
+  %4 = call i32 @leaf(i32 %3)
+  ret i32 %4
+
+done:
+  ret i32 0
+}
+
+; CHECK: define i32 @atomic(i32 %a) #[[NOIO:[0-9]+]]
+define i32 @atomic(i32 %a) {
+  %1 = atomicrmw add i32* @counter, i32 %a seq_cst
+  %2 = call i32 @leaf(i32 %1)
+  ret i32 %2
+}
+
+; CHECK: define i32 @libcall(i8* %s) #[[NOIO]]
+define i32 @libcall(i8* %s) {
+  %1 = call i64 @strlen(i8* %s)
+  %2 = trunc i64 %1 to i32
+  ret i32 %2
+}
+
+; CHECK: define i32 @unknown(i32 %a) {
+define i32 @unknown(i32 %a) {
+  %1 = call i32 @external(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define i32 @indirect(i32 %a) {
+define i32 @indirect(i32 %a) {
+  %1 = load i32 (i32)*, i32 (i32)** @callback, align 8
+  %2 = call i32 %1(i32 %a)
+  ret i32 %2
+}
+
+; the linker may keep another definition of a weak or an ODR function, so
+; their bodies prove nothing
+; CHECK: define weak i32 @weak_leaf(i32 %a) {
+define weak i32 @weak_leaf(i32 %a) {
+  ret i32 %a
+}
+
+; CHECK: define linkonce_odr i32 @odr_leaf(i32 %a) {
+define linkonce_odr i32 @odr_leaf(i32 %a) {
+  ret i32 %a
+}
+
+; CHECK: define i32 @calls_weak(i32 %a) {
+define i32 @calls_weak(i32 %a) {
+  %1 = call i32 @weak_leaf(i32 %a)
+  ret i32 %1
+}
+
+; CHECK: define void @io() #[[IO:[0-9]+]]
+define void @io() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @calls_io() {
+define void @calls_io() {
+  call void @io()
+  ret void
+}
+
+; the comparator is called by qsort, so the library call is not IO-free
+; CHECK: define void @sorts(i8* %p) {
+define void @sorts(i8* %p) {
+  call void @qsort(i8* %p, i64 4, i64 4, i32 (i8*, i8*)* @compare_io)
+  ret void
+}
+
+; CHECK: define i32 @compare_io(i8* %a, i8* %b) #[[IO]]
+define i32 @compare_io(i8* %a, i8* %b) {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret i32 0
+}
+
+declare i64 @strlen(i8*)
+
+declare void @qsort(i8*, i64, i64, i32 (i8*, i8*)*)
+
+declare i32 @external(i32)
+
+declare i32 @puts(i8*)
+
+; CHECK-DAG: attributes #[[NOSYNC]] = { nosync "icsa-noio" }
+; CHECK-DAG: attributes #[[NOIO]] = { "icsa-noio" }
+; CHECK-DAG: attributes #[[IO]] = { "icsa-io"="1" }
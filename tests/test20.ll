@@ -0,0 +1,146 @@
+; RUN: opt -load %bindir/%testeelib -coalesce-loop-io -aioattr-coalesce-buffer=64 -S < %s | FileCheck %s
+
+
+%struct._IO_FILE = type opaque
+
+; CHECK-LABEL: define void @emit
+; CHECK: %aioattr.buf = alloca [64 x i8]
+; CHECK: store i64 0, i64* %aioattr.len
+; CHECK-NOT: call i32 @fputc
+; CHECK: icmp eq i64 %{{.*}}, 64
+; CHECK: call i64 @fwrite(i8* %{{.*}}, i64 1, i64 %{{.*}}, %struct._IO_FILE* %f)
+; CHECK-NOT: call i32 @fputc
+; CHECK-LABEL: early.exit:
+; CHECK: call i64 @fwrite(i8* %{{.*}}, i64 1, i64 %{{.*}}, %struct._IO_FILE* %f)
+; CHECK-LABEL: exit.loopexit:
+; CHECK: call i64 @fwrite(i8* %{{.*}}, i64 1, i64 %{{.*}}, %struct._IO_FILE* %f)
+define void @emit(i8* %s, i64 %n, %struct._IO_FILE* %f) {
+entry:
+  %cmp0 = icmp sgt i64 %n, 0
+  br i1 %cmp0, label %loop.preheader, label %exit
+
+loop.preheader:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %loop.preheader ], [ %i.next, %latch ]
+  %p = getelementptr inbounds i8, i8* %s, i64 %i
+  %c = load i8, i8* %p, align 1
+  %z = icmp eq i8 %c, 0
+  br i1 %z, label %early.exit, label %latch
+
+latch:
+  %c.ext = sext i8 %c to i32
+  %0 = call i32 @fputc(i32 %c.ext, %struct._IO_FILE* %f)
+  %i.next = add nsw i64 %i, 1
+  %cmp = icmp slt i64 %i.next, %n
+  br i1 %cmp, label %loop, label %exit.loopexit
+
+early.exit:
+  br label %exit
+
+exit.loopexit:
+  br label %exit
+
+exit:
+  ret void
+}
+
+; the return value of the write is used
+; CHECK-LABEL: define i32 @checked
+; CHECK: call i32 @fputc
+; CHECK-NOT: call i64 @fwrite
+define i32 @checked(i32 %n, %struct._IO_FILE* %f) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %r = call i32 @fputc(i32 %i, %struct._IO_FILE* %f)
+  %i.next = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %r
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret i32 %r
+}
+
+; other calls might write to the same stream
+; CHECK-LABEL: define void @mixed
+; CHECK: call i32 @fputc
+; CHECK-NOT: call i64 @fwrite
+define void @mixed(i32 %n, %struct._IO_FILE* %f) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %0 = call i32 @fputc(i32 %i, %struct._IO_FILE* %f)
+  call void @log_progress(i32 %i)
+  %i.next = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; the trap leaves the loop without passing through an exit block
+; CHECK-LABEL: define void @trapping
+; CHECK: call i32 @fputc
+; CHECK-NOT: call i64 @fwrite
+define void @trapping(i32 %n, %struct._IO_FILE* %f) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %0 = call i32 @fputc(i32 %i, %struct._IO_FILE* %f)
+  %bad = icmp eq i32 %i, 42
+  br i1 %bad, label %fail, label %latch
+
+fail:
+  call void @llvm.trap()
+  br label %latch
+
+latch:
+  %i.next = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; the lifetime markers are no calls at run time
+; CHECK-LABEL: define void @annotated
+; CHECK-NOT: call i32 @fputc
+; CHECK: call i64 @fwrite
+define void @annotated(i32 %n, %struct._IO_FILE* %f) {
+entry:
+  %tmp = alloca i32, align 4
+  %tmp.cast = bitcast i32* %tmp to i8*
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  call void @llvm.lifetime.start.p0i8(i64 4, i8* %tmp.cast)
+  %0 = call i32 @fputc(i32 %i, %struct._IO_FILE* %f)
+  call void @llvm.lifetime.end.p0i8(i64 4, i8* %tmp.cast)
+  %i.next = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+declare i32 @fputc(i32, %struct._IO_FILE*)
+
+declare void @log_progress(i32)
+
+declare void @llvm.trap()
+
+declare void @llvm.lifetime.start.p0i8(i64, i8*)
+
+declare void @llvm.lifetime.end.p0i8(i64, i8*)
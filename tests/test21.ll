@@ -0,0 +1,68 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-hotness -S < %s | FileCheck %s
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-hotness -aioattr-stats=%t -disable-output < %s
+; RUN: FileCheck -check-prefix=REPORT %s < %t
+
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+
+; REPORT: hot: profiled 50.00 5000
+; REPORT-NEXT: hot: in_loop 32.00
+; REPORT-NEXT: hot: error_path 0.01
+
+; CHECK: define void @error_path(i1 %fail) #[[COLD:[0-9]+]]
+define void @error_path(i1 %fail) {
+entry:
+  br i1 %fail, label %error, label %exit, !prof !0
+
+error:
+  %0 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  br label %exit
+
+exit:
+  ret void
+}
+
+; CHECK: define void @in_loop(i32 %n) #[[HOT:[0-9]+]]
+define void @in_loop(i32 %n) {
+entry:
+  br label %loop
+
+; CHECK: br i1 %cmp, label %loop, label %exit, !llvm.loop ![[LOOP:[0-9]+]]
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %0 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  %i.next = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; CHECK: define void @profiled(i32 %n) #[[PROFILED:[0-9]+]]
+define void @profiled(i32 %n) !prof !1 {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %0 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  %i.next = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit, !prof !2
+
+exit:
+  ret void
+}
+
+declare i32 @puts(i8*)
+
+!0 = !{!"branch_weights", i32 1, i32 99}
+!1 = !{!"function_entry_count", i64 100}
+!2 = !{!"branch_weights", i32 49, i32 1}
+
+; CHECK-DAG: attributes #[[COLD]] = { "icsa-io"="1" "icsa-io-freq"="0.01" }
+; CHECK-DAG: attributes #[[HOT]] = { "icsa-io"="1" "icsa-io-freq"="32.00" }
+; CHECK-DAG: attributes #[[PROFILED]] = { "icsa-io"="1" "icsa-io-count"="5000" "icsa-io-freq"="50.00" }
+; CHECK-DAG: ![[LOOP]] = distinct !{![[LOOP]], ![[FREQ:[0-9]+]]}
+; CHECK-DAG: ![[FREQ]] = !{!"icsa.io.freq", double 3.200000e+01}
@@ -0,0 +1,87 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-instrument -S < %s | FileCheck %s
+
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+
+; CHECK: @aioattr.site_base = internal global i32 -2147483648
+; CHECK: c"greet:puts#0\00"
+; CHECK: c"greet:puts#1\00"
+; CHECK: c"guarded:puts#0\00"
+; CHECK: c"guarded:puts#1\00"
+; CHECK: @aioattr.site_names = private constant [4 x i8*]
+; CHECK: @llvm.global_ctors = appending global {{.*}} @aioattr.module_ctor
+
+; CHECK-LABEL: define void @greet()
+; CHECK: [[START:%[0-9]+]] = call i64 @__aioattr_probe_begin()
+; CHECK-NEXT: call i32 @puts
+; CHECK-NEXT: [[BASE:%[0-9]+]] = load i32, i32* @aioattr.site_base
+; CHECK-NEXT: [[SITE:%[0-9]+]] = add i32 [[BASE]], 0
+; CHECK-NEXT: call void @__aioattr_probe_end(i32 [[SITE]], i64 [[START]])
+; CHECK: call i64 @__aioattr_probe_begin()
+; CHECK-NEXT: call i32 @puts
+; CHECK-NEXT: load i32, i32* @aioattr.site_base
+; CHECK-NEXT: add i32 {{%[0-9]+}}, 1
+define void @greet() {
+entry:
+  %0 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK-LABEL: define i32 @compute(i32 %x)
+; CHECK-NOT: __aioattr_probe
+; CHECK: ret i32
+define i32 @compute(i32 %x) {
+entry:
+  %0 = add i32 %x, 1
+  ret i32 %0
+}
+
+; the end probe of an invoke starts its normal destination, and a shared
+; destination gets an edge block of its own
+; CHECK-LABEL: define void @guarded(i1 %c)
+; CHECK: call i64 @__aioattr_probe_begin()
+; CHECK-NEXT: invoke i32 @puts
+; CHECK-NEXT: to label %cont unwind label %lpad
+; CHECK: cont:
+; CHECK-NEXT: load i32, i32* @aioattr.site_base
+; CHECK-NEXT: add i32 {{%[0-9]+}}, 2
+; CHECK-NEXT: call void @__aioattr_probe_end
+; CHECK: call i64 @__aioattr_probe_begin()
+; CHECK-NEXT: invoke i32 @puts
+; CHECK-NEXT: to label %[[SPLIT:.*]] unwind label %lpad
+; CHECK: [[SPLIT]]:
+; CHECK-NEXT: load i32, i32* @aioattr.site_base
+; CHECK-NEXT: add i32 {{%[0-9]+}}, 3
+; CHECK-NEXT: call void @__aioattr_probe_end
+; CHECK-NEXT: br label %done
+; CHECK: done:
+; CHECK-NEXT: ret void
+define void @guarded(i1 %c) personality i8* bitcast (i32 (...)* @__gxx_personality_v0 to i8*) {
+entry:
+  %0 = invoke i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+          to label %cont unwind label %lpad
+
+cont:
+  br i1 %c, label %more, label %done
+
+more:
+  %1 = invoke i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+          to label %done unwind label %lpad
+
+done:
+  ret void
+
+lpad:
+  %2 = landingpad { i8*, i32 }
+          cleanup
+  resume { i8*, i32 } %2
+}
+
+; CHECK-LABEL: define internal void @aioattr.module_ctor()
+; CHECK: call i32 @__aioattr_register_sites
+; CHECK: store i32 {{%[0-9]+}}, i32* @aioattr.site_base
+
+declare i32 @puts(i8*)
+
+declare i32 @__gxx_personality_v0(...)
@@ -0,0 +1,30 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-fn-whitelist=%inputdatadir/test23-whitelist.txt -aioattr-fn-blacklist=%inputdatadir/test23-blacklist.txt -S < %s | FileCheck %s
+
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+
+; CHECK: define void @log_info() #0
+define void @log_info() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @log_debug() {
+define void @log_debug() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @report() #0
+define void @report() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @reporter() {
+define void @reporter() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+declare i32 @puts(i8*)
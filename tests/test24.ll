@@ -0,0 +1,27 @@
+; RUN: rm -f %t
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-stats-aggregate=%t -disable-output < %s
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-stats-aggregate=%t -disable-output < %s
+; RUN: FileCheck %s < %t
+
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+
+; CHECK: {"module": "<stdin>", "functions_processed": 3, "attribute_applications": 2, "functions_altered": ["zeta", "alpha"], "functions_skipped": []}
+; CHECK-NEXT: {"module": "<stdin>", "functions_processed": 3, "attribute_applications": 2, "functions_altered": ["zeta", "alpha"], "functions_skipped": []}
+; CHECK-NOT: module
+
+define void @zeta() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+define void @quiet() {
+  ret void
+}
+
+define void @alpha() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+declare i32 @puts(i8*)
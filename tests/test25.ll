@@ -0,0 +1,23 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute-function -S < %s | FileCheck %s
+; RUN: opt -load %bindir/%testeelib -O2 -aioattr-ep=vectorizer-start -aioattr-function-pass -S < %s | FileCheck -check-prefix=PIPELINE %s
+
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+
+; CHECK: define void @greet() #0
+; PIPELINE: define void @greet() {{.*}}#[[IO:[0-9]+]]
+define void @greet() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @compute(i32 %x) {
+define i32 @compute(i32 %x) {
+  %1 = add i32 %x, 1
+  ret i32 %1
+}
+
+declare i32 @puts(i8*)
+
+; CHECK: attributes #0 = { "icsa-io"="1" }
+; PIPELINE: attributes #[[IO]] = { {{.*}}"icsa-io"="1"{{.*}} }
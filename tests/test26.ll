@@ -0,0 +1,36 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-budget-insts=2 -aioattr-stats=%t -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=REPORT %s < %t
+
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+
+; REPORT: 3
+; REPORT-NEXT: 2
+; REPORT-NEXT: small
+; REPORT-NEXT: large
+; REPORT-NEXT: skipped: large
+; REPORT-NOT: skipped
+
+; CHECK: define void @small() #[[SMALL:[0-9]+]]
+define void @small() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define i32 @large(i32 %x) #[[LARGE:[0-9]+]]
+define i32 @large(i32 %x) {
+  %1 = add i32 %x, 1
+  %2 = add i32 %1, 1
+  ret i32 %2
+}
+
+; CHECK: define i32 @quiet(i32 %x) {
+define i32 @quiet(i32 %x) {
+  %1 = add i32 %x, 1
+  ret i32 %1
+}
+
+declare i32 @puts(i8*)
+
+; CHECK-DAG: attributes #[[SMALL]] = { "icsa-io"="1" }
+; CHECK-DAG: attributes #[[LARGE]] = { "icsa-io"="63" "icsa-io-unknown" }
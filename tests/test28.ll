@@ -0,0 +1,24 @@
+; RUN: llvm-as < %s > %t.bc
+; RUN: echo 'test.*' > %t.whitelist
+; RUN: %toolsdir/aioattr-scan/aioattr-scan -fn-whitelist=%t.whitelist %t.bc -o %t
+; RUN: FileCheck %s < %t
+
+; the address of puts is taken only in the body of a function that is not
+; scanned, which must still be loaded to resolve the indirect call
+
+@.str = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+
+; CHECK: 1
+; CHECK-NEXT: 1
+; CHECK-NEXT: {{.*}}.bc:test_indirect 1
+define void @test_indirect(i32 (i8*)* %f) {
+  %1 = call i32 %f(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+define void @helper() {
+  call void @test_indirect(i32 (i8*)* @puts)
+  ret void
+}
+
+declare i32 @puts(i8*)
@@ -0,0 +1,20 @@
+; RUN: %toolsdir/aioattr-prof/aioattr-prof %inputdatadir/test29-run1.aioprof | FileCheck -check-prefix=SINGLE %s
+; RUN: %toolsdir/aioattr-prof/aioattr-prof %inputdatadir/test29-run1.aioprof %inputdatadir/test29-run2.aioprof | FileCheck -check-prefix=MERGED %s
+; RUN: %toolsdir/aioattr-prof/aioattr-prof -sort=count -top=1 %inputdatadir/test29-run1.aioprof %inputdatadir/test29-run2.aioprof | FileCheck -check-prefix=TOP %s
+; RUN: not %toolsdir/aioattr-prof/aioattr-prof %inputdatadir/test29-run1.aioprof %inputdatadir/test29-truncated.aioprof 2>&1 | FileCheck -check-prefix=TRUNCATED %s
+
+; the profiles are checked in as written by the runtime on a little-endian
+; host; the sites of several runs are merged by module and site name
+
+; SINGLE: 3 9000 3000 main.c log:fprintf#0
+; SINGLE-NEXT: 10 5000 500 main.c main:puts#0
+; SINGLE-NOT: main.c
+
+; MERGED: 3 9000 3000 main.c log:fprintf#0
+; MERGED-NEXT: 15 6000 400 main.c main:puts#0
+; MERGED-NEXT: 1 100 100 util.c dump:fwrite#0
+
+; TOP: 15 6000 400 main.c main:puts#0
+; TOP-NOT: fprintf
+
+; TRUNCATED: could not read profile: '{{.*}}test29-truncated.aioprof'
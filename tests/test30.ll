@@ -0,0 +1,30 @@
+; RUN: rm -rf %t && mkdir -p %t
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-cache-dir=%t -S < %inputdatadir/test30-before.ll | FileCheck --check-prefix=BEFORE %s
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-cache-dir=%t -aioattr-stats=%t/after.json -aioattr-report-format=json -S < %s | FileCheck %s
+; RUN: FileCheck --check-prefix=AFTER %s < %t/after.json
+
+; the cache key covers the body, so an edited ODR function is analysed again
+; while an unchanged one is still taken from the cache
+
+; BEFORE: define linkonce_odr void @edited() {
+
+; AFTER-DAG: {"name": "edited", {{.*}}"source": "scan"
+; AFTER-DAG: {"name": "unchanged", {{.*}}"source": "cache"
+
+@.str = private unnamed_addr constant [13 x i8] c"hello world!\00", align 1
+
+; CHECK: define linkonce_odr void @edited() [[IO:#[0-9]+]]
+define linkonce_odr void @edited() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define linkonce_odr i32 @unchanged(i32 %a) {
+define linkonce_odr i32 @unchanged(i32 %a) {
+  %1 = mul i32 %a, %a
+  ret i32 %1
+}
+
+declare i32 @puts(i8*)
+
+; CHECK: attributes [[IO]] = {{.*}}"icsa-io"
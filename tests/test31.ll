@@ -0,0 +1,52 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-fn-whitelist=%inputdatadir/test31-whitelist.txt -S < %s | FileCheck %s
+
+; the whitelist patterns are matched by a single automaton, except for the
+; one with a back-reference, which is still matched on its own
+
+@.str = private unnamed_addr constant [13 x i8] c"hello world!\00", align 1
+
+; CHECK: define void @io_12_a() [[IO:#[0-9]+]]
+define void @io_12_a() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @io_12_c() {
+define void @io_12_c() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @ab_dbl07() [[IO]]
+define void @ab_dbl07() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @ab_dbl7() {
+define void @ab_dbl7() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @xx_io() [[IO]]
+define void @xx_io() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @xy_io() {
+define void @xy_io() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+; CHECK: define void @plain_name() [[IO]]
+define void @plain_name() {
+  %1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+declare i32 @puts(i8*)
+
+; CHECK: attributes [[IO]] = {{.*}}"icsa-io"
@@ -0,0 +1,30 @@
+; RUN: opt -load %bindir/%testeelib -apply-io-attribute -aioattr-ipo -aioattr-budget-insts=2 -aioattr-stats=%t -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=REPORT %s < %t
+
+; the budget also holds in the interprocedural mode, where the functions not
+; scanned pass all categories on to their callers
+
+; REPORT: skipped: large
+; REPORT-NOT: skipped
+
+; CHECK: define i32 @large(i32 %x) #[[LARGE:[0-9]+]]
+define i32 @large(i32 %x) {
+  %1 = add i32 %x, 1
+  %2 = add i32 %1, 1
+  ret i32 %2
+}
+
+; CHECK: define i32 @calls_large(i32 %x) #[[CALLER:[0-9]+]]
+define i32 @calls_large(i32 %x) {
+  %1 = call i32 @large(i32 %x)
+  ret i32 %1
+}
+
+; CHECK: define i32 @quiet(i32 %x) {
+define i32 @quiet(i32 %x) {
+  %1 = add i32 %x, 1
+  ret i32 %1
+}
+
+; CHECK-DAG: attributes #[[LARGE]] = { "icsa-io"="63" "icsa-io-unknown" }
+; CHECK-DAG: attributes #[[CALLER]] = { "icsa-io"="63" }
@@ -0,0 +1,79 @@
+//
+//
+//
+
+// merges the profiles written by instrumented programs and prints one line
+// per IO call site: calls, total and mean nanoseconds, module and site name
+
+#include "llvm/Support/CommandLine.h"
+// using llvm::cl::opt
+// using llvm::cl::list
+// using llvm::cl::ParseCommandLineOptions
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::outs
+// using llvm::errs
+
+#include <algorithm>
+// using std::stable_sort
+
+#include <vector>
+// using std::vector
+
+#include <string>
+// using std::string
+
+#include <cstdlib>
+// using EXIT_SUCCESS
+// using EXIT_FAILURE
+
+#include "IOProfile.hpp"
+
+static llvm::cl::list<std::string>
+    InputFilenames(llvm::cl::Positional, llvm::cl::OneOrMore,
+                   llvm::cl::desc("<profile files>"));
+
+enum class SortKind : int { TIME, COUNT };
+
+static llvm::cl::opt<SortKind> SortOrder(
+    "sort", llvm::cl::desc("site order"), llvm::cl::init(SortKind::TIME),
+    llvm::cl::values(clEnumValN(SortKind::TIME, "time", "total time first"),
+                     clEnumValN(SortKind::COUNT, "count", "most calls first")));
+
+static llvm::cl::opt<unsigned>
+    NumTop("top", llvm::cl::desc("number of sites printed (0: all)"),
+           llvm::cl::init(0));
+
+int main(int argc, char *argv[]) {
+  llvm::cl::ParseCommandLineOptions(argc, argv, "IO call site profiles\n");
+
+  icsa::IOProfile profile;
+
+  for (const auto &filename : InputFilenames)
+    if (!profile.read(filename)) {
+      llvm::errs() << "could not read profile: \'" << filename << "\'\n";
+
+      return EXIT_FAILURE;
+    }
+
+  std::vector<icsa::IOProfile::Site> sites(profile.getSites());
+
+  std::stable_sort(sites.begin(), sites.end(),
+                   [](const icsa::IOProfile::Site &L,
+                      const icsa::IOProfile::Site &R) {
+                     if (SortKind::COUNT == SortOrder)
+                       return L.Calls > R.Calls;
+
+                     return L.Nanoseconds > R.Nanoseconds;
+                   });
+
+  if (NumTop && sites.size() > NumTop)
+    sites.resize(NumTop);
+
+  for (const auto &site : sites)
+    llvm::outs() << site.Calls << " " << site.Nanoseconds << " "
+                 << (site.Calls ? site.Nanoseconds / site.Calls : 0) << " "
+                 << site.Module << " " << site.Name << "\n";
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,419 @@
+//
+//
+//
+
+// scans many bitcode files concurrently without running opt on each of them
+// and emits a single report of the functions performing IO; input files are
+// memory-mapped and loaded lazily, so that only the bodies of the functions
+// passing the whitelist are materialized, unless they make indirect calls
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
+#include "llvm/IR/LLVMContext.h"
+// using llvm::LLVMContext
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/InstrTypes.h"
+// using llvm::CallBase
+
+#include "llvm/ADT/Triple.h"
+// using llvm::Triple
+
+#include "llvm/Analysis/TargetLibraryInfo.h"
+// using llvm::TargetLibraryInfoImpl
+// using llvm::TargetLibraryInfo
+
+#include "llvm/Bitcode/BitcodeReader.h"
+// using llvm::getLazyBitcodeModule
+
+#include "llvm/Support/MemoryBuffer.h"
+// using llvm::MemoryBuffer
+
+#include "llvm/Support/LineIterator.h"
+// using llvm::line_iterator
+
+#include "llvm/Support/ThreadPool.h"
+// using llvm::ThreadPool
+
+#include "llvm/Support/Threading.h"
+// using llvm::hardware_concurrency
+
+#include "llvm/Support/Error.h"
+// using llvm::toString
+
+#include "llvm/Support/CommandLine.h"
+// using llvm::cl::opt
+// using llvm::cl::list
+// using llvm::cl::ParseCommandLineOptions
+
+#include "llvm/Support/FileSystem.h"
+// using llvm::sys::fs::OpenFlags
+
+#include "llvm/Support/Format.h"
+// using llvm::format
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::raw_fd_ostream
+// using llvm::errs
+
+#include <vector>
+// using std::vector
+
+#include <string>
+// using std::string
+
+#include <fstream>
+// using std::ifstream
+
+#include <system_error>
+// using std::error_code
+
+#include <cstdlib>
+// using EXIT_SUCCESS
+// using EXIT_FAILURE
+
+#include "BWList.hpp"
+
+#include "ApplyIOAttribute.hpp"
+
+static llvm::cl::list<std::string>
+    InputFilenames(llvm::cl::Positional, llvm::cl::ZeroOrMore,
+                   llvm::cl::desc("<bitcode files>"));
+
+static llvm::cl::opt<std::string> InputListFilename(
+    "input-list",
+    llvm::cl::desc("file with one bitcode filename per line"));
+
+static llvm::cl::opt<std::string>
+    OutputFilename("o", llvm::cl::init("-"),
+                   llvm::cl::desc("report output filename"));
+
+enum class ReportFormatKind : int { TEXT, JSON };
+
+static llvm::cl::opt<ReportFormatKind> ReportFormat(
+    "format", llvm::cl::desc("report format"),
+    llvm::cl::init(ReportFormatKind::TEXT),
+    llvm::cl::values(clEnumValN(ReportFormatKind::TEXT, "text",
+                                "counters and IO function names"),
+                     clEnumValN(ReportFormatKind::JSON, "json",
+                                "one record per analyzed function")));
+
+static llvm::cl::opt<std::string>
+    FuncWhileListFilename("fn-whitelist",
+                          llvm::cl::desc("function whitelist"));
+
+static llvm::cl::opt<std::string>
+    FuncBlackListFilename("fn-blacklist",
+                          llvm::cl::desc("function blacklist"));
+
+static llvm::cl::opt<unsigned> NumThreads(
+    "j",
+    llvm::cl::desc("number of files scanned concurrently (0: all cores)"),
+    llvm::cl::init(0));
+
+namespace {
+
+struct FunctionRecord {
+  std::string Name;
+  unsigned Categories = icsa::IOC_NONE;
+  std::string Callee;
+};
+
+struct FileRecord {
+  std::string Error;
+  unsigned NumFunctionsProcessed = 0;
+  std::vector<FunctionRecord> Functions;
+};
+
+bool ReadBWList(const std::string &Filename, BWList &List) {
+  std::ifstream listFile{Filename};
+
+  if (!listFile.is_open())
+    return false;
+
+  List.addRegex(listFile);
+  List.compile();
+
+  return true;
+}
+
+bool ReadInputList(llvm::StringRef Filename,
+                   std::vector<std::string> &Filenames) {
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(Filename);
+  if (!bufferOrErr)
+    return false;
+
+  for (llvm::line_iterator li(**bufferOrErr), le; li != le; ++li)
+    if (!li->trim().empty())
+      Filenames.push_back(li->trim().str());
+
+  return true;
+}
+
+// every file gets its own context, since contexts must not be shared
+// between threads
+void ScanFile(const std::string &Filename, BWList &FuncWhiteList,
+              BWList &FuncBlackList, FileRecord &Record) {
+  // no null terminator is required, so that the file can be memory-mapped
+#if LLVM_VERSION_MAJOR >= 13
+  // the file size parameter was replaced by a text mode flag in LLVM 13
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(Filename, false, false);
+#else
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(Filename, -1, false);
+#endif
+  if (!bufferOrErr) {
+    Record.Error = bufferOrErr.getError().message();
+
+    return;
+  }
+
+  llvm::LLVMContext ctx;
+  auto moduleOrErr =
+      llvm::getLazyBitcodeModule((*bufferOrErr)->getMemBufferRef(), ctx);
+  if (!moduleOrErr) {
+    Record.Error = llvm::toString(moduleOrErr.takeError());
+
+    return;
+  }
+
+  auto &module = **moduleOrErr;
+  llvm::TargetLibraryInfoImpl TLII(llvm::Triple(module.getTargetTriple()));
+  llvm::TargetLibraryInfo TLI(TLII);
+  icsa::ApplyIOAttribute aioattr(TLI);
+
+  std::vector<const llvm::Function *> selected;
+  bool hasIndirectCalls = false;
+
+  for (auto &func : module) {
+    if (func.isDeclaration())
+      continue;
+
+    if (!FuncWhileListFilename.empty() &&
+        !FuncWhiteList.matches(func.getName().data()))
+      continue;
+
+    if (!FuncBlackListFilename.empty() &&
+        FuncBlackList.matches(func.getName().data()))
+      continue;
+
+    if (auto err = func.materialize()) {
+      Record.Error = llvm::toString(std::move(err));
+
+      return;
+    }
+
+    selected.push_back(&func);
+
+    for (const auto &bb : func)
+      for (const auto &inst : bb) {
+        const auto *call = llvm::dyn_cast<llvm::CallBase>(&inst);
+        hasIndirectCalls |= call && call->isIndirectCall();
+      }
+  }
+
+  // the candidate callees of indirect calls are the functions whose address
+  // is taken, which may happen in any body of the module
+  if (hasIndirectCalls)
+    if (auto err = module.materializeAll()) {
+      Record.Error = llvm::toString(std::move(err));
+
+      return;
+    }
+
+  aioattr.classify(module);
+
+  for (const auto *func : selected) {
+    Record.NumFunctionsProcessed++;
+
+    icsa::IOTrigger trigger;
+    const auto categories = aioattr.getIOCategories(*func, trigger);
+
+    FunctionRecord rec;
+    rec.Name = func->getName().str();
+    rec.Categories = categories;
+
+    if (trigger.Callee)
+      rec.Callee = trigger.Callee->getName().str();
+
+    Record.Functions.push_back(std::move(rec));
+  }
+
+  return;
+}
+
+void WriteJSONString(llvm::raw_ostream &OS, llvm::StringRef Str) {
+  OS << '"';
+
+  for (const auto c : Str) {
+    if ('"' == c || '\\' == c)
+      OS << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      OS << llvm::format("\\u%04x", c);
+    else
+      OS << c;
+  }
+
+  OS << '"';
+
+  return;
+}
+
+void WriteReport(llvm::raw_ostream &OS,
+                 const std::vector<std::string> &Filenames,
+                 const std::vector<FileRecord> &Records) {
+  unsigned numProcessed = 0;
+  unsigned numIO = 0;
+
+  for (const auto &rec : Records) {
+    numProcessed += rec.NumFunctionsProcessed;
+
+    for (const auto &func : rec.Functions)
+      numIO += func.Categories ? 1 : 0;
+  }
+
+  if (ReportFormatKind::TEXT == ReportFormat) {
+    OS << numProcessed << "\n";
+    OS << numIO << "\n";
+
+    for (std::size_t i = 0; i < Records.size(); ++i)
+      for (const auto &func : Records[i].Functions)
+        if (func.Categories)
+          OS << Filenames[i] << ":" << func.Name << " " << func.Categories
+             << "\n";
+
+    return;
+  }
+
+  OS << "{\n";
+  OS << "  \"functions_processed\": " << numProcessed << ",\n";
+  OS << "  \"functions_with_io\": " << numIO << ",\n";
+  OS << "  \"files\": [";
+
+  for (std::size_t i = 0; i < Records.size(); ++i) {
+    const auto &rec = Records[i];
+
+    OS << (i ? ",\n" : "\n") << "    {\"name\": ";
+    WriteJSONString(OS, Filenames[i]);
+
+    if (!rec.Error.empty()) {
+      OS << ", \"error\": ";
+      WriteJSONString(OS, rec.Error);
+    }
+
+    OS << ", \"functions\": [";
+
+    for (std::size_t j = 0; j < rec.Functions.size(); ++j) {
+      const auto &func = rec.Functions[j];
+
+      OS << (j ? ",\n" : "\n") << "      {\"name\": ";
+      WriteJSONString(OS, func.Name);
+      OS << ", \"io\": " << (func.Categories ? "true" : "false");
+
+      if (func.Categories) {
+        OS << ", \"callee\": ";
+        WriteJSONString(OS, func.Callee);
+        OS << ", \"categories\": [";
+
+        const char *sep = "";
+        for (unsigned bit = 1; bit & icsa::IOC_ALL; bit <<= 1)
+          if (func.Categories & bit) {
+            OS << sep;
+            WriteJSONString(OS, icsa::getIOCategoryName(
+                                    static_cast<icsa::IOCategory>(bit)));
+            sep = ", ";
+          }
+
+        OS << "]";
+      }
+
+      OS << "}";
+    }
+
+    OS << (rec.Functions.empty() ? "]}" : "\n    ]}");
+  }
+
+  OS << "\n  ]\n}\n";
+
+  return;
+}
+
+} // namespace anonymous end
+
+int main(int argc, char *argv[]) {
+  llvm::cl::ParseCommandLineOptions(argc, argv,
+                                    "parallel bitcode IO scanner\n");
+
+  std::vector<std::string> filenames(InputFilenames.begin(),
+                                     InputFilenames.end());
+
+  if (!InputListFilename.empty() &&
+      !ReadInputList(InputListFilename, filenames)) {
+    llvm::errs() << "could not read file: \'" << InputListFilename << "\'\n";
+
+    return EXIT_FAILURE;
+  }
+
+  BWList funcWhiteList;
+  if (!FuncWhileListFilename.empty() &&
+      !ReadBWList(FuncWhileListFilename, funcWhiteList)) {
+    llvm::errs() << "could not open file: \'" << FuncWhileListFilename
+                 << "\'\n";
+
+    return EXIT_FAILURE;
+  }
+
+  BWList funcBlackList;
+  if (!FuncBlackListFilename.empty() &&
+      !ReadBWList(FuncBlackListFilename, funcBlackList)) {
+    llvm::errs() << "could not open file: \'" << FuncBlackListFilename
+                 << "\'\n";
+
+    return EXIT_FAILURE;
+  }
+
+  // results are collected per file and merged in input order, so that the
+  // report does not depend on the thread schedule
+  std::vector<FileRecord> records(filenames.size());
+
+  {
+    // each idle thread picks up the next pending file, which evens out files
+    // of uneven size; zero threads selects all cores
+    llvm::ThreadPool pool(llvm::hardware_concurrency(NumThreads));
+
+    for (std::size_t i = 0; i < filenames.size(); ++i)
+      pool.async([&, i] {
+        ScanFile(filenames[i], funcWhiteList, funcBlackList, records[i]);
+      });
+
+    pool.wait();
+  }
+
+  auto status = EXIT_SUCCESS;
+
+  for (std::size_t i = 0; i < records.size(); ++i)
+    if (!records[i].Error.empty()) {
+      llvm::errs() << "could not scan file: \'" << filenames[i]
+                   << "\' reason: " << records[i].Error << "\n";
+      status = EXIT_FAILURE;
+    }
+
+  std::error_code err;
+  llvm::raw_fd_ostream report(OutputFilename, err, llvm::sys::fs::OF_Text);
+
+  if (err) {
+    llvm::errs() << "could not open file: \'" << OutputFilename
+                 << "\' reason: " << err.message() << "\n";
+
+    return EXIT_FAILURE;
+  }
+
+  WriteReport(report, filenames, records);
+
+  return status;
+}
@@ -0,0 +1,54 @@
+//
+//
+//
+
+// combines the per-module IO summaries written with -aioattr-thinlto-summary
+// during the ThinLTO thin link and emits the transitive IO facts consumed by
+// the backends with -aioattr-thinlto-facts
+
+#include "llvm/Support/CommandLine.h"
+// using llvm::cl::opt
+// using llvm::cl::list
+// using llvm::cl::ParseCommandLineOptions
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::errs
+
+#include <string>
+// using std::string
+
+#include <cstdlib>
+// using EXIT_SUCCESS
+// using EXIT_FAILURE
+
+#include "IOSummary.hpp"
+
+static llvm::cl::list<std::string>
+    InputFilenames(llvm::cl::Positional, llvm::cl::OneOrMore,
+                   llvm::cl::desc("<module IO summaries>"));
+
+static llvm::cl::opt<std::string>
+    OutputFilename("o", llvm::cl::Required,
+                   llvm::cl::desc("IO facts output filename"));
+
+int main(int argc, char *argv[]) {
+  llvm::cl::ParseCommandLineOptions(argc, argv,
+                                    "ThinLTO IO summary resolution\n");
+
+  icsa::IOSummary summary;
+
+  for (const auto &filename : InputFilenames)
+    if (!summary.read(filename)) {
+      llvm::errs() << "could not read file: \'" << filename << "\'\n";
+
+      return EXIT_FAILURE;
+    }
+
+  if (!icsa::IOSummary::writeFacts(OutputFilename, summary.resolve())) {
+    llvm::errs() << "could not open file: \'" << OutputFilename << "\'\n";
+
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -24,6 +24,9 @@
 // using llvm::Pass
 // using llvm::PassInfo
 
+#include "llvm/InitializePasses.h"
+// using llvm::initializeTargetLibraryInfoWrapperPassPass
+
 #include "llvm/Analysis/TargetLibraryInfo.h"
 // using llvm::TargetLibraryInfoWrapperPass
 // using llvm::TargetLibraryInfo
@@ -78,11 +81,9 @@ public:
       std::string fullFilename{m_TestDataDir};
       fullFilename += AssemblyHolder;
 
-      m_Module =
-          llvm::parseAssemblyFile(fullFilename, err, llvm::getGlobalContext());
+      m_Module = llvm::parseAssemblyFile(fullFilename, err, m_Context);
     } else {
-      m_Module = llvm::parseAssemblyString(AssemblyHolder, err,
-                                           llvm::getGlobalContext());
+      m_Module = llvm::parseAssemblyString(AssemblyHolder, err, m_Context);
     }
 
     std::string errMsg;
@@ -125,11 +126,11 @@ public:
       }
 
       bool runOnModule(llvm::Module &M) override {
-        const auto &TLI =
-            getAnalysis<llvm::TargetLibraryInfoWrapperPass>().getTLI();
         test_result_map::const_iterator found;
 
-        const auto *func = M.getFunction("test");
+        auto *func = M.getFunction("test");
+        const auto &TLI =
+            getAnalysis<llvm::TargetLibraryInfoWrapperPass>().getTLI(*func);
 
         // subcase
         found = lookup("has IO call");
@@ -142,6 +143,49 @@ public:
           EXPECT_EQ(ev, rv) << found->first;
         }
 
+        // subcase
+        found = lookup("IO categories");
+        if (found != std::end(m_trm)) {
+          ApplyIOAttribute ioattr(TLI);
+          ioattr.classify(M);
+
+          const auto &rv = ioattr.getIOCategories(*func);
+          const auto &ev =
+              boost::apply_visitor(test_result_visitor(), found->second);
+          EXPECT_EQ(ev, rv) << found->first;
+        }
+
+        // subcase
+        found = lookup("use-list IO categories");
+        if (found != std::end(m_trm)) {
+          ApplyIOAttribute ioattr(TLI);
+          ioattr.classify(M);
+
+          FunctionIOSiteMap ioSites;
+          IOTrigger trigger;
+          unsigned rv = IOC_NONE;
+
+          if (ioattr.collectIOSites(M, ioSites))
+            rv = ioattr.getIOCategories(ioSites[func], trigger);
+
+          const auto &ev =
+              boost::apply_visitor(test_result_visitor(), found->second);
+          EXPECT_EQ(ev, rv) << found->first;
+        }
+
+        // subcase
+        found = lookup("classification hits");
+        if (found != std::end(m_trm)) {
+          ApplyIOAttribute ioattr(TLI);
+          ioattr.classify(M);
+          ioattr.hasIO(*func);
+
+          const auto &rv = ioattr.getNumClassificationHits();
+          const auto &ev =
+              boost::apply_visitor(test_result_visitor(), found->second);
+          EXPECT_EQ(ev, rv) << found->first;
+        }
+
         return false;
       }
 
@@ -172,6 +216,8 @@ public:
   }
 
 protected:
+  // the context has to outlive the module
+  llvm::LLVMContext m_Context;
   std::unique_ptr<llvm::Module> m_Module;
   const char *m_TestDataDir;
 };
@@ -185,6 +231,34 @@ TEST_F(TestApplyIOAttribute, LibIOFuncExists1) {
   ExpectTestPass(trm);
 }
 
+TEST_F(TestApplyIOAttribute, ClassifiedDeclarationLookup) {
+  ParseAssembly("test01.ll");
+
+  test_result_map trm;
+
+  trm.insert({"has IO call", true});
+  trm.insert({"classification hits", 1u});
+  ExpectTestPass(trm);
+}
+
+TEST_F(TestApplyIOAttribute, LibIOFuncCategories) {
+  ParseAssembly("test01.ll");
+
+  test_result_map trm;
+
+  trm.insert({"IO categories", static_cast<unsigned>(IOC_FILE_WRITE)});
+  ExpectTestPass(trm);
+}
+
+TEST_F(TestApplyIOAttribute, UseListLibIOFuncCategories) {
+  ParseAssembly("test01.ll");
+
+  test_result_map trm;
+
+  trm.insert({"use-list IO categories", static_cast<unsigned>(IOC_FILE_WRITE)});
+  ExpectTestPass(trm);
+}
+
 TEST_F(TestApplyIOAttribute, LibIOFuncExists2) {
   ParseAssembly("test02.ll");
 
@@ -212,6 +286,15 @@ TEST_F(TestApplyIOAttribute, IgnoreNonIOLibFunc) {
   ExpectTestPass(trm);
 }
 
+TEST_F(TestApplyIOAttribute, LibIOFuncAfterNonIOLibFunc) {
+  ParseAssembly("test05.ll");
+
+  test_result_map trm;
+
+  trm.insert({"has IO call", true});
+  ExpectTestPass(trm);
+}
+
 TEST_F(TestApplyIOAttribute, CxxIOFuncExists1) {
   ParseAssembly("test10.ll");
 
@@ -221,6 +304,18 @@ TEST_F(TestApplyIOAttribute, CxxIOFuncExists1) {
   ExpectTestPass(trm);
 }
 
+TEST_F(TestApplyIOAttribute, CxxIOFuncCategories) {
+  ParseAssembly("test10.ll");
+
+  test_result_map trm;
+
+  trm.insert({"IO categories",
+              static_cast<unsigned>(IOC_CONSOLE | IOC_FILE_WRITE)});
+  trm.insert({"use-list IO categories",
+              static_cast<unsigned>(IOC_CONSOLE | IOC_FILE_WRITE)});
+  ExpectTestPass(trm);
+}
+
 TEST_F(TestApplyIOAttribute, CxxIOFuncExists2) {
   ParseAssembly("test11.ll");
 
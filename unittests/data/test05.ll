@@ -0,0 +1,12 @@
+@.str = private unnamed_addr constant [13 x i8] c"hello world!\00", align 1
+
+define void @test() {
+entry:
+  %call = call i64 @strlen(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  %call1 = call i32 @puts(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @.str, i32 0, i32 0))
+  ret void
+}
+
+declare i64 @strlen(i8*)
+
+declare i32 @puts(i8*)
@@ -0,0 +1,196 @@
+#!/usr/bin/env python
+#
+# generates the IO catalog include file from its data file
+#
+# the output is split in sections guarded by GET_<section> macros, so that
+# each translation unit picks only the tables it needs:
+#   GET_IO_CATALOG_VERSION  the catalog version derived from the entries
+#   GET_IO_LIBFUNC_CATALOG  IO_LIBFUNC(<LibFunc name>, <categories>) entries
+#   GET_IO_NAME_CATALOG     a perfect hash table of the posix names
+#   GET_IO_CXX_CATALOG      the C++ stream tables
+
+from __future__ import print_function
+
+import argparse
+import sys
+
+CATEGORIES = {
+    'console': 'IOC_CONSOLE',
+    'file-read': 'IOC_FILE_READ',
+    'file-write': 'IOC_FILE_WRITE',
+    'fs-metadata': 'IOC_FS_METADATA',
+    'process': 'IOC_PROCESS',
+    'stream-lock': 'IOC_STREAM_LOCK',
+}
+
+SECTIONS = [
+    'libc', 'posix', 'cxx-class', 'cxx-abbrev', 'cxx-method',
+    'cxx-file-method', 'cxx-func', 'cxx-marker'
+]
+
+# sections whose entries carry no categories
+PLAIN_SECTIONS = ['cxx-method', 'cxx-file-method', 'cxx-func']
+
+# must be kept in sync with hashIOName() in lib/IOCatalog.cpp
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+MASK32 = 0xffffffff
+
+
+def fnv1a(data, seed=0):
+    h = FNV_OFFSET ^ seed
+    for c in bytearray(data.encode('ascii')):
+        h ^= c
+        h = (h * FNV_PRIME) & MASK32
+    return h
+
+
+def parse(filename):
+    catalog = dict((s, []) for s in SECTIONS)
+
+    with open(filename) as f:
+        for lineno, line in enumerate(f, 1):
+            fields = line.split('#', 1)[0].split()
+            if not fields:
+                continue
+
+            def fail(msg):
+                sys.exit('{}:{}: {}'.format(filename, lineno, msg))
+
+            section, name, categories = fields[0], fields[1:2], fields[2:]
+            if section not in catalog:
+                fail('unknown section: ' + section)
+            if not name:
+                fail('missing name')
+            for c in categories:
+                if c not in CATEGORIES:
+                    fail('unknown category: ' + c)
+            if section in PLAIN_SECTIONS and categories:
+                fail('unexpected categories in section: ' + section)
+            if section not in PLAIN_SECTIONS and not categories:
+                fail('missing categories')
+            if name[0] in [e[0] for e in catalog[section]]:
+                fail('duplicate entry: ' + name[0])
+
+            catalog[section].append((name[0], categories))
+
+    return catalog
+
+
+def format_categories(categories):
+    return ' | '.join(CATEGORIES[c] for c in categories)
+
+
+def get_version(catalog):
+    entries = []
+    for s in SECTIONS:
+        for name, categories in catalog[s]:
+            entries.append(' '.join([s, name] + categories))
+
+    return fnv1a('\n'.join(entries))
+
+
+# hash and displace: the names are distributed into buckets by an unseeded
+# hash, then each bucket gets the seed that places all of its names into free
+# slots, starting with the largest buckets
+def build_perfect_hash(names):
+    size = 1
+    while size < len(names):
+        size *= 2
+    num_buckets = max(1, size // 2)
+
+    buckets = [[] for _ in range(num_buckets)]
+    for n in names:
+        buckets[fnv1a(n) & (num_buckets - 1)].append(n)
+
+    seeds = [0] * num_buckets
+    slots = [None] * size
+
+    for b in sorted(range(num_buckets), key=lambda b: -len(buckets[b])):
+        if not buckets[b]:
+            continue
+
+        for seed in range(1, 1 << 20):
+            placed = set(fnv1a(n, seed) & (size - 1) for n in buckets[b])
+            if len(placed) == len(buckets[b]) and \
+                    all(slots[i] is None for i in placed):
+                break
+        else:
+            sys.exit('could not find a perfect hash seed')
+
+        seeds[b] = seed
+        for n in buckets[b]:
+            slots[fnv1a(n, seed) & (size - 1)] = n
+
+    return seeds, slots
+
+
+def write_entries(out, decl, entries):
+    out.write('{} = {{\n'.format(decl))
+    out.write(',\n'.join('    ' + e for e in entries))
+    out.write('};\n')
+
+
+def generate(catalog, out):
+    out.write('// generated by gen_io_catalog.py; do not edit\n\n')
+
+    out.write('#ifdef GET_IO_CATALOG_VERSION\n')
+    out.write('const unsigned IOCatalogVersion = {:#010x}u;\n'.format(
+        get_version(catalog)))
+    out.write('#endif // GET_IO_CATALOG_VERSION\n\n')
+
+    out.write('#ifdef GET_IO_LIBFUNC_CATALOG\n')
+    for name, categories in catalog['libc']:
+        out.write('IO_LIBFUNC({}, {})\n'.format(
+            name, format_categories(categories)))
+    out.write('#endif // GET_IO_LIBFUNC_CATALOG\n\n')
+
+    names = dict(catalog['posix'])
+    seeds, slots = build_perfect_hash(sorted(names))
+    entries = [
+        '{{"{}", {}}}'.format(n, format_categories(names[n]))
+        if n else '{nullptr, IOC_NONE}' for n in slots
+    ]
+
+    out.write('#ifdef GET_IO_NAME_CATALOG\n')
+    write_entries(out, 'const uint32_t IONameBucketSeeds[{}]'.format(
+        len(seeds)), ['{}u'.format(s) for s in seeds])
+    write_entries(out, 'const IONameEntry IONameTable[{}]'.format(len(slots)),
+                  entries)
+    out.write('#endif // GET_IO_NAME_CATALOG\n\n')
+
+    out.write('#ifdef GET_IO_CXX_CATALOG\n')
+    for section, decl in [
+        ('cxx-class', 'const CxxStreamEntry CxxStreamClasses[]'),
+        ('cxx-abbrev', 'const CxxStreamEntry CxxStreamAbbreviations[]'),
+        ('cxx-method', 'const llvm::StringRef CxxStreamMethods[]'),
+        ('cxx-file-method', 'const llvm::StringRef CxxFileStreamMethods[]'),
+        ('cxx-func', 'const llvm::StringRef CxxStreamFuncs[]'),
+        ('cxx-marker', 'const CxxStreamEntry CxxStreamTypeMarkers[]'),
+    ]:
+        if section in PLAIN_SECTIONS:
+            entries = ['"{}"'.format(n) for n, _ in catalog[section]]
+        else:
+            entries = [
+                '{{"{}", {}}}'.format(n, format_categories(c))
+                for n, c in catalog[section]
+            ]
+        write_entries(out, decl, entries)
+    out.write('#endif // GET_IO_CXX_CATALOG\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('catalog', help='IO catalog data file')
+    parser.add_argument('-o', dest='output', required=True,
+                        help='generated include file')
+    args = parser.parse_args()
+
+    catalog = parse(args.catalog)
+
+    with open(args.output, 'w') as out:
+        generate(catalog, out)
+
+
+if __name__ == '__main__':
+    main()